@@ -0,0 +1,245 @@
+#pragma once
+#include "common.hpp"
+#include "engine/components.hpp"
+
+// stlib
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+// What an animated entity is, picks its row in the clip table
+enum class ANIMATED_KIND
+{
+	PLAYER,
+	ENEMY_FLYER,
+	ENEMY_CHARGER,
+	ENEMY_BOSS,
+	RIFLE,
+	GRENADE_LAUNCHER,
+	GRENADE,
+	KIND_COUNT
+};
+
+// Player state a clip needs before it is switched to
+enum class CLIP_GATE
+{
+	ALWAYS,
+	ON_GROUND,
+	IN_AIR,
+	REFLECTING,
+	DEAD
+};
+
+struct AnimationClip
+{
+	ANIMATED_KIND kind;
+	Skin skin;
+	ANIMATION_TYPE type;
+	GEOMETRY_BUFFER_ID geometry;
+	TEXTURE_ASSET_ID texture;
+	// skins that flicker between two sheets (Schrodinger cat), same as texture otherwise
+	TEXTURE_ASSET_ID flicker_texture;
+	int frames;
+	int frame_time; // ms per frame
+	bool loop;
+	CLIP_GATE gate;
+};
+
+// Every animation in the game. Non player kinds only have DEFAULT skin clips, a player skin
+// without a clip for some animation falls back to the DEFAULT skin's one.
+constexpr AnimationClip animation_clips[] = {
+	// kind, skin, type, geometry, texture, flicker texture, frames, frame time, loop, gate
+	{ANIMATED_KIND::PLAYER, Skin::DEFAULT, IDLE, GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::DEFAULT, WALK, GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::DEFAULT, JUMP, GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP, 1, 1, false, CLIP_GATE::IN_AIR},
+	{ANIMATED_KIND::PLAYER, Skin::DEFAULT, SPIN, GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN, 9, 50, false, CLIP_GATE::REFLECTING},
+	{ANIMATED_KIND::PLAYER, Skin::DEFAULT, DEATH, GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH, 1, 1, false, CLIP_GATE::DEAD},
+
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_XMAS, IDLE, GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE_XMAS, TEXTURE_ASSET_ID::CAT_IDLE_XMAS, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_XMAS, WALK, GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK_XMAS, TEXTURE_ASSET_ID::CAT_WALK_XMAS, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_XMAS, JUMP, GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP_XMAS, TEXTURE_ASSET_ID::CAT_JUMP_XMAS, 1, 1, false, CLIP_GATE::IN_AIR},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_XMAS, SPIN, GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN_XMAS, TEXTURE_ASSET_ID::CAT_SPIN_XMAS, 9, 50, false, CLIP_GATE::REFLECTING},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_XMAS, DEATH, GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH_XMAS, TEXTURE_ASSET_ID::CAT_DEATH_XMAS, 1, 1, false, CLIP_GATE::DEAD},
+
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SLIME, IDLE, GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE_SLIME, TEXTURE_ASSET_ID::CAT_IDLE_SLIME, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SLIME, WALK, GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK_SLIME, TEXTURE_ASSET_ID::CAT_WALK_SLIME, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SLIME, JUMP, GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP_SLIME, TEXTURE_ASSET_ID::CAT_JUMP_SLIME, 1, 1, false, CLIP_GATE::IN_AIR},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SLIME, SPIN, GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN_SLIME, TEXTURE_ASSET_ID::CAT_SPIN_SLIME, 9, 50, false, CLIP_GATE::REFLECTING},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SLIME, DEATH, GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH_SLIME, TEXTURE_ASSET_ID::CAT_DEATH_SLIME, 1, 1, false, CLIP_GATE::DEAD},
+
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SCH, IDLE, GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE_SCH_ALIVE, TEXTURE_ASSET_ID::CAT_IDLE_SCH_DEAD, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SCH, WALK, GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK_SCH_ALIVE, TEXTURE_ASSET_ID::CAT_WALK_SCH_DEAD, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SCH, JUMP, GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP_SCH_ALIVE, TEXTURE_ASSET_ID::CAT_JUMP_SCH_DEAD, 1, 1, false, CLIP_GATE::IN_AIR},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SCH, SPIN, GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN_SCH_ALIVE, TEXTURE_ASSET_ID::CAT_SPIN_SCH_DEAD, 9, 50, false, CLIP_GATE::REFLECTING},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_SCH, DEATH, GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH_SCH, TEXTURE_ASSET_ID::CAT_DEATH_SCH, 1, 1, false, CLIP_GATE::DEAD},
+
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_RAINBOW, IDLE, GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE_RAINBOW, TEXTURE_ASSET_ID::CAT_IDLE_RAINBOW, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_RAINBOW, WALK, GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK_RAINBOW, TEXTURE_ASSET_ID::CAT_WALK_RAINBOW, 6, 100, true, CLIP_GATE::ON_GROUND},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_RAINBOW, JUMP, GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP_RAINBOW, TEXTURE_ASSET_ID::CAT_JUMP_RAINBOW, 1, 1, false, CLIP_GATE::IN_AIR},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_RAINBOW, SPIN, GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN_RAINBOW, TEXTURE_ASSET_ID::CAT_SPIN_RAINBOW, 9, 50, false, CLIP_GATE::REFLECTING},
+	{ANIMATED_KIND::PLAYER, Skin::CAT_SKIN_RAINBOW, DEATH, GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH_RAINBOW, TEXTURE_ASSET_ID::CAT_DEATH_RAINBOW, 1, 1, false, CLIP_GATE::DEAD},
+
+	{ANIMATED_KIND::ENEMY_FLYER, Skin::DEFAULT, IDLE, GEOMETRY_BUFFER_ID::ENEMY_FLYER, TEXTURE_ASSET_ID::ENEMY_FLYER, TEXTURE_ASSET_ID::ENEMY_FLYER, 8, 75, true, CLIP_GATE::ALWAYS},
+	{ANIMATED_KIND::ENEMY_FLYER, Skin::DEFAULT, DEATH, GEOMETRY_BUFFER_ID::ENEMY_FLYER_DEATH, TEXTURE_ASSET_ID::ENEMY_FLYER_DEATH, TEXTURE_ASSET_ID::ENEMY_FLYER_DEATH, 9, 100, false, CLIP_GATE::ALWAYS},
+
+	{ANIMATED_KIND::ENEMY_CHARGER, Skin::DEFAULT, IDLE, GEOMETRY_BUFFER_ID::ENEMY_CHARGER, TEXTURE_ASSET_ID::ENEMY_CHARGER, TEXTURE_ASSET_ID::ENEMY_CHARGER, 6, 75, true, CLIP_GATE::ALWAYS},
+	{ANIMATED_KIND::ENEMY_CHARGER, Skin::DEFAULT, ATTACK, GEOMETRY_BUFFER_ID::ENEMY_CHARGER_ATTACK, TEXTURE_ASSET_ID::ENEMY_CHARGER_ATTACK, TEXTURE_ASSET_ID::ENEMY_CHARGER_ATTACK, 6, 75, true, CLIP_GATE::ALWAYS},
+	{ANIMATED_KIND::ENEMY_CHARGER, Skin::DEFAULT, DEATH, GEOMETRY_BUFFER_ID::ENEMY_CHARGER_DEATH, TEXTURE_ASSET_ID::ENEMY_CHARGER_DEATH, TEXTURE_ASSET_ID::ENEMY_CHARGER_DEATH, 9, 100, false, CLIP_GATE::ALWAYS},
+
+	{ANIMATED_KIND::ENEMY_BOSS, Skin::DEFAULT, IDLE, GEOMETRY_BUFFER_ID::ENEMY_BOSS_IDLE, TEXTURE_ASSET_ID::ENEMY_BOSS_IDLE, TEXTURE_ASSET_ID::ENEMY_BOSS_IDLE, 10, 100, true, CLIP_GATE::ALWAYS},
+	{ANIMATED_KIND::ENEMY_BOSS, Skin::DEFAULT, JUMP, GEOMETRY_BUFFER_ID::ENEMY_BOSS_JUMP, TEXTURE_ASSET_ID::ENEMY_BOSS_JUMP, TEXTURE_ASSET_ID::ENEMY_BOSS_JUMP, 1, 1, false, CLIP_GATE::ALWAYS},
+	{ANIMATED_KIND::ENEMY_BOSS, Skin::DEFAULT, DEATH, GEOMETRY_BUFFER_ID::ENEMY_BOSS_DEATH, TEXTURE_ASSET_ID::ENEMY_BOSS_DEATH, TEXTURE_ASSET_ID::ENEMY_BOSS_DEATH, 18, 100, false, CLIP_GATE::ALWAYS},
+
+	{ANIMATED_KIND::RIFLE, Skin::DEFAULT, IDLE, GEOMETRY_BUFFER_ID::RIFLE_IDLE, TEXTURE_ASSET_ID::RIFLE_IDLE, TEXTURE_ASSET_ID::RIFLE_IDLE, 1, 1, false, CLIP_GATE::ALWAYS},
+	{ANIMATED_KIND::RIFLE, Skin::DEFAULT, ATTACK, GEOMETRY_BUFFER_ID::RIFLE_ATTACK, TEXTURE_ASSET_ID::RIFLE_ATTACK, TEXTURE_ASSET_ID::RIFLE_ATTACK, 5, 45, false, CLIP_GATE::ALWAYS},
+
+	{ANIMATED_KIND::GRENADE_LAUNCHER, Skin::DEFAULT, IDLE, GEOMETRY_BUFFER_ID::GRENADE_LAUNCHER_IDLE, TEXTURE_ASSET_ID::GRENADE_LAUNCHER_IDLE, TEXTURE_ASSET_ID::GRENADE_LAUNCHER_IDLE, 1, 1, false, CLIP_GATE::ALWAYS},
+	{ANIMATED_KIND::GRENADE_LAUNCHER, Skin::DEFAULT, ATTACK, GEOMETRY_BUFFER_ID::GRENADE_LAUNCHER_ATTACK, TEXTURE_ASSET_ID::GRENADE_LAUNCHER_ATTACK, TEXTURE_ASSET_ID::GRENADE_LAUNCHER_ATTACK, 7, 45, false, CLIP_GATE::ALWAYS},
+
+	{ANIMATED_KIND::GRENADE, Skin::DEFAULT, EXPLODE, GEOMETRY_BUFFER_ID::GRENADE_EXPLODE, TEXTURE_ASSET_ID::GRENADE_EXPLODE, TEXTURE_ASSET_ID::GRENADE_EXPLODE, 12, 25, false, CLIP_GATE::ALWAYS},
+};
+
+// Dense (kind, skin, type) -> clip index table, built at compile time from the list above so
+// it does not depend on the enums' values
+namespace animation_clip_table
+{
+	constexpr size_t CLIP_COUNT = sizeof(animation_clips) / sizeof(animation_clips[0]);
+	constexpr size_t KIND_COUNT = (size_t)ANIMATED_KIND::KIND_COUNT;
+
+	constexpr size_t skin_count()
+	{
+		size_t count = 0;
+		for (const AnimationClip &clip : animation_clips)
+			count = (size_t)clip.skin + 1 > count ? (size_t)clip.skin + 1 : count;
+		return count;
+	}
+
+	constexpr size_t type_count()
+	{
+		size_t count = 0;
+		for (const AnimationClip &clip : animation_clips)
+			count = (size_t)clip.type + 1 > count ? (size_t)clip.type + 1 : count;
+		return count;
+	}
+
+	constexpr size_t SKIN_COUNT = skin_count();
+	constexpr size_t TYPE_COUNT = type_count();
+
+	constexpr size_t slot(ANIMATED_KIND kind, size_t skin, size_t type)
+	{
+		return ((size_t)kind * SKIN_COUNT + skin) * TYPE_COUNT + type;
+	}
+
+	constexpr std::array<int16_t, KIND_COUNT * SKIN_COUNT * TYPE_COUNT> build()
+	{
+		std::array<int16_t, KIND_COUNT * SKIN_COUNT * TYPE_COUNT> index{};
+		for (size_t i = 0; i < index.size(); i++)
+			index[i] = -1;
+		for (size_t i = 0; i < CLIP_COUNT; i++)
+		{
+			const AnimationClip &clip = animation_clips[i];
+			index[slot(clip.kind, (size_t)clip.skin, (size_t)clip.type)] = (int16_t)i;
+		}
+		return index;
+	}
+
+	constexpr auto index = build();
+
+	// frames per animation geometry, 0 for geometries no clip uses
+	constexpr std::array<int8_t, geometry_count> build_geometry_frames()
+	{
+		std::array<int8_t, geometry_count> frames{};
+		for (const AnimationClip &clip : animation_clips)
+			frames[(size_t)clip.geometry] = (int8_t)clip.frames;
+		return frames;
+	}
+
+	constexpr auto geometry_frames = build_geometry_frames();
+
+	// Player sheets of one geometry share their layout in every skin, they are the layers of one
+	// texture array per geometry
+	struct SkinSheetLayer
+	{
+		GEOMETRY_BUFFER_ID geometry = GEOMETRY_BUFFER_ID::GEOMETRY_COUNT;
+		int layer = -1;
+	};
+
+	constexpr std::array<SkinSheetLayer, texture_count> build_skin_sheet_layers()
+	{
+		std::array<SkinSheetLayer, texture_count> layers{};
+		std::array<int, geometry_count> used{};
+		for (const AnimationClip &clip : animation_clips)
+		{
+			if (clip.kind != ANIMATED_KIND::PLAYER)
+				continue;
+			for (TEXTURE_ASSET_ID texture : {clip.texture, clip.flicker_texture})
+			{
+				SkinSheetLayer &sheet = layers[(size_t)texture];
+				if (sheet.layer >= 0)
+					continue;
+				sheet.geometry = clip.geometry;
+				sheet.layer = used[(size_t)clip.geometry]++;
+			}
+		}
+		return layers;
+	}
+
+	constexpr auto skin_sheet_layers = build_skin_sheet_layers();
+
+	constexpr bool skin_sheets_have_one_geometry()
+	{
+		for (const AnimationClip &clip : animation_clips)
+		{
+			if (clip.kind == ANIMATED_KIND::PLAYER &&
+				(skin_sheet_layers[(size_t)clip.texture].geometry != clip.geometry ||
+				 skin_sheet_layers[(size_t)clip.flicker_texture].geometry != clip.geometry))
+				return false;
+		}
+		return true;
+	}
+
+	constexpr bool geometry_layouts_agree()
+	{
+		for (const AnimationClip &clip : animation_clips)
+		{
+			if (geometry_frames[(size_t)clip.geometry] != clip.frames)
+				return false;
+		}
+		return true;
+	}
+}
+
+static_assert(animation_clip_table::geometry_layouts_agree(), "clips sharing a geometry need the same frame count");
+static_assert(animation_clip_table::skin_sheets_have_one_geometry(), "a player sheet can only be in one texture array");
+
+// Animation geometries are only names for a sheet layout, every one of them is drawn with the
+// SPRITE quad. Frames sit side by side in u, each covering all of v. 0 if the geometry is not
+// an animation.
+constexpr int animationGeometryFrames(GEOMETRY_BUFFER_ID geometry)
+{
+	return (size_t)geometry < (size_t)geometry_count ? animation_clip_table::geometry_frames[(size_t)geometry] : 0;
+}
+
+using SkinSheetLayer = animation_clip_table::SkinSheetLayer;
+
+// Texture array and layer a player sheet is loaded into, layer -1 for other textures
+constexpr SkinSheetLayer skinSheetLayer(TEXTURE_ASSET_ID texture)
+{
+	return (size_t)texture < (size_t)texture_count ? animation_clip_table::skin_sheet_layers[(size_t)texture]
+													: SkinSheetLayer{};
+}
+
+// The clip for an animation, nullptr if the kind does not have it
+constexpr const AnimationClip *findAnimationClip(ANIMATED_KIND kind, Skin skin, ANIMATION_TYPE type)
+{
+	using namespace animation_clip_table;
+	if ((size_t)type >= TYPE_COUNT)
+		return nullptr;
+	int16_t i = (size_t)skin < SKIN_COUNT ? index[slot(kind, (size_t)skin, (size_t)type)] : -1;
+	if (i < 0 && skin != Skin::DEFAULT)
+		i = index[slot(kind, (size_t)Skin::DEFAULT, (size_t)type)];
+	return i < 0 ? nullptr : &animation_clips[i];
+}
+
+static_assert(findAnimationClip(ANIMATED_KIND::PLAYER, Skin::DEFAULT, IDLE) != nullptr, "player needs an idle clip");
@@ -1,21 +0,0 @@
-#pragma once
-#include "renderer/render_system.hpp"
-
-void initCatIdle(RenderSystem &renderSystem);
-void initCatWalk(RenderSystem &renderSystem);
-void initCatJump(RenderSystem &renderSystem);
-void initCatSpin(RenderSystem &renderSystem);
-void initCatDeath(RenderSystem &renderSystem);
-void initEnemyBossIdle(RenderSystem &renderSystem);
-void initEnemyBossJump(RenderSystem &renderSystem);
-void initEnemyBossDeath(RenderSystem &renderSystem);
-void initEnemyFlyer(RenderSystem &renderSystem);
-void initEnemyFlyerDeath(RenderSystem &renderSystem);
-void initEnemyCharger(RenderSystem &renderSystem);
-void initEnemyChargerAttack(RenderSystem &renderSystem);
-void initEnemyChargerDeath(RenderSystem &renderSystem);
-void initWeaponIdle(RenderSystem &renderSystem);
-void initWeaponAttack(RenderSystem &renderSystem);
-void initGrenadeLauncherWeaponIdle(RenderSystem &renderSystem);
-void initGrenadeLauncherWeaponAttack(RenderSystem &renderSystem);
-void initExplode(RenderSystem &renderSystem);
@@ -1,470 +1,306 @@
 #include "animation_system.hpp"
+#include "engine/job_system.hpp"
+#include "engine/swap_remove.hpp"
 
-void AnimationSystem::applyAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width,
-									 WorldSystem &world)
+// stlib
+#include <cmath>
+
+SparseComponentContainer<AnimationFrame> animation_frames;
+AnimationLodStats animation_lod_stats;
+float AnimationSystem::time_ms = 0.f;
+
+namespace {
+	// below this the update is done before the other threads would have woken up
+	const size_t PARALLEL_ANIMATIONS = 1024;
+
+	// one frame per animated entity, new animations start at frame 0
+	void syncAnimationFrames()
+	{
+		for (Entity entity : registry.animations.entities)
+		{
+			if (!animation_frames.has(entity))
+				animation_frames.emplace(entity).clip_start = AnimationSystem::time_ms;
+		}
+		remove_entities_if(animation_frames,
+						   [](Entity entity, const AnimationFrame &) { return !registry.animations.has(entity); });
+	}
+}
+
+void AnimationSystem::step(float elapsed_ms, WorldSystem &world)
+{
+	static unsigned int tick = 0;
+	tick++;
+	time_ms += elapsed_ms;
+	syncAnimationFrames();
+
+	// the camera is at the center of the screen
+	vec2 view_min = vec2(-INFINITY);
+	vec2 view_max = vec2(INFINITY);
+	if (registry.cameras.size() > 0)
+	{
+		vec2 camera_position = registry.cameras.get(registry.cameras.entities[0]).position;
+		vec2 half_screen = vec2(window_width_px, window_height_px) / 2.f;
+		view_min = camera_position - half_screen;
+		view_max = camera_position + half_screen;
+	}
+
+	// every entity only writes its own animation, render request and frame, so the range can
+	// be split freely. The player flicker state is shared but there is only one player.
+	auto update_range = [elapsed_ms, view_min, view_max, &world](size_t begin, size_t end)
+	{
+		uint64_t updated = 0, reduced_skipped = 0, suspended_skipped = 0;
+		for (size_t i = begin; i < end; i++)
+		{
+			Entity entity = animation_frames.entities[i];
+			AnimationFrame &frame = animation_frames.components[i];
+			frame.pending_ms += elapsed_ms;
+
+			// reduced rate entities take turns so the updates spread over the interval
+			ANIMATION_LOD lod = lodOf(entity, view_min, view_max);
+			if (lod == ANIMATION_LOD::SUSPENDED)
+			{
+				suspended_skipped++;
+				continue;
+			}
+			if (lod == ANIMATION_LOD::REDUCED && (tick + (unsigned int)entity) % REDUCED_INTERVAL != 0)
+			{
+				reduced_skipped++;
+				continue;
+			}
+
+			applyAnimation(entity, frame.pending_ms, frame, world);
+			frame.pending_ms = 0.f;
+			updated++;
+		}
+		animation_lod_stats.updated.fetch_add(updated, std::memory_order_relaxed);
+		animation_lod_stats.reduced_skipped.fetch_add(reduced_skipped, std::memory_order_relaxed);
+		animation_lod_stats.suspended_skipped.fetch_add(suspended_skipped, std::memory_order_relaxed);
+	};
+
+	size_t count = animation_frames.size();
+	if (count < PARALLEL_ANIMATIONS || job_system.thread_count() == 0)
+	{
+		update_range(0, count);
+		return;
+	}
+
+	JobHandle job = job_system.parallel_for(count, 256, update_range);
+	job_system.wait(job);
+}
+
+ANIMATION_LOD AnimationSystem::lodOf(Entity entity, vec2 view_min, vec2 view_max)
+{
+	// gameplay waits for the grenade's explosion, the player and its weapon are always close
+	if (registry.players.has(entity) || registry.weapons.has(entity) || registry.grenades.has(entity) ||
+		!registry.motions.has(entity))
+		return ANIMATION_LOD::FULL;
+
+	// px between the sprite's box and the screen, 0 when they overlap
+	const Motion &motion = registry.motions.get(entity);
+	vec2 half_size = abs(motion.scale) / 2.f;
+	vec2 gap = max(max(view_min - (motion.position + half_size), (motion.position - half_size) - view_max), vec2(0.f));
+	float distance = std::max(gap.x, gap.y);
+
+	if (distance <= 0.f)
+		return ANIMATION_LOD::FULL;
+	return distance <= REDUCED_MARGIN_PX ? ANIMATION_LOD::REDUCED : ANIMATION_LOD::SUSPENDED;
+}
+
+void AnimationSystem::applyAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame, WorldSystem &world)
 {
 	if (registry.players.has(entity))
 	{
-		handlePlayerAnimation(entity, elapsed_ms, frame_current, frame_width, world);
+		handlePlayerAnimation(entity, elapsed_ms, frame, world);
 	}
 	else if (registry.enemies.has(entity))
 	{
-		handleEnemyAnimation(entity, elapsed_ms, frame_current, frame_width);
+		handleEnemyAnimation(entity, elapsed_ms, frame);
 	}
 	else if (registry.weapons.has(entity))
 	{
-		handleWeaponAnimation(entity, elapsed_ms, frame_current, frame_width);
+		handleWeaponAnimation(entity, elapsed_ms, frame);
 	}
 	else if (registry.grenades.has(entity))
 	{
-		handleGrenadeAnimation(entity, elapsed_ms, frame_current, frame_width);
+		handleGrenadeAnimation(entity, elapsed_ms, frame);
 	}
 }
 
-// handle player animation
-void AnimationSystem::handlePlayerAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width,
-											WorldSystem &world)
+// switch to a clip when its gate is open and advance its frames, looping clips only record
+// when they started and leave the frame to the vertex shader
+void AnimationSystem::playClip(Entity entity, const AnimationClip &clip, bool gate_open, bool flicker, float elapsed_ms,
+							   AnimationFrame &frame)
 {
-	auto &player = registry.players.get(entity);
 	auto &animation = registry.animations.get(entity);
 	auto &renderRequest = registry.renderRequests.get(entity);
 
+	bool switched = gate_open && renderRequest.used_geometry != clip.geometry;
+	if (gate_open)
+		setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current, clip.geometry,
+					 flicker ? clip.flicker_texture : clip.texture);
+	if (switched)
+		frame.clip_start = time_ms;
+
+	// the sheet on screen belongs to this clip, so its frame only depends on the start time
+	if (clip.loop && renderRequest.used_geometry == clip.geometry)
+	{
+		frame.clip_frames = clip.frames;
+		frame.clip_frame_time = (float)clip.frame_time;
+		frame.clip_loop = clip.loop;
+		return;
+	}
+
+	// back on the CPU, carry on from the frame the shader was showing
+	if (frame.clip_frames > 0 && !switched)
+		animation.frame_current = clipFrameAt(frame, time_ms);
+	frame.clip_frames = 0;
+
 	animation.frame_counter -= elapsed_ms;
+	updateAnimationFrame(animation.frame_counter, animation.frame_current, clip.frames, clip.frame_time, clip.loop);
+	frame.frame_current = animation.frame_current;
+}
 
+// handle player animation
+void AnimationSystem::handlePlayerAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame, WorldSystem &world)
+{
+	auto &player = registry.players.get(entity);
+	auto &animation = registry.animations.get(entity);
 
-	/*if (animation.type == DEATH && player.is_dead)
-	{
-		setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-					 GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH, 1, frame_width);
+	const AnimationClip *clip = findAnimationClip(ANIMATED_KIND::PLAYER, world.selected_skin, animation.type);
+	if (!clip)
 		return;
-	}*/
 
-	switch (world.selected_skin)
+	bool gate_open = true;
+	switch (clip->gate)
 	{
-	case Skin::DEFAULT:
-		switch (animation.type)
-
-		{
-		case IDLE:
-			if (player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE, CAT_IDLE_WALK_FRAME,frame_width);
-        updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-        break;
-
-		case WALK:
-			if (player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK, CAT_IDLE_WALK_FRAME, frame_width);
-        updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-        break;
-
-		case JUMP:
-			if (!player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP, CAT_JUMP_FRAME, frame_width);
-        updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_JUMP_FRAME, 1, false);
-        break;
-		case SPIN: 
-			if (player.reflect_active)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN, CAT_SPIN_FRAME, frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_SPIN_FRAME, 50, false);
-			break;
-		case DEATH:
-			if (player.is_dead)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH, 1, frame_width);
-			return;
-		default:
-			break;
-		}
-	case Skin::CAT_SKIN_XMAS:
-		switch (animation.type)
-		{
-		case IDLE:
-			if (player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE_XMAS, CAT_IDLE_WALK_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-			break;
-
-		case WALK:
-			if (player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK_XMAS, CAT_IDLE_WALK_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-			break;
-
-		case JUMP:
-			if (!player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP_XMAS, CAT_JUMP_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_JUMP_FRAME, 1, false);
-			break;
-		case SPIN:
-			if (player.reflect_active)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN_XMAS, CAT_SPIN_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_SPIN_FRAME, 50, false);
-			break;
-		case DEATH:
-			if (player.is_dead)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH_XMAS, 1, frame_width);
-			return;
-		default:
-			break;
-		}
-	case Skin::CAT_SKIN_SLIME:
-		switch (animation.type)
-		{
-		case IDLE:
-			if (player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE_SLIME, CAT_IDLE_WALK_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-			break;
-
-		case WALK:
-			if (player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK_SLIME, CAT_IDLE_WALK_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-			break;
-
-		case JUMP:
-			if (!player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP_SLIME, CAT_JUMP_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_JUMP_FRAME, 1, false);
-			break;
-		case SPIN:
-			if (player.reflect_active)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN_SLIME, CAT_SPIN_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_SPIN_FRAME, 50, false);
-			break;
-		case DEATH:
-			if (player.is_dead)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH_SLIME, 1, frame_width);
-			return;
-		default:
-			break;
-		}
-	case Skin::CAT_SKIN_SCH:
-		{
-			// Static variables for toggling logic
-			static float toggle_timer = 0.0f;
-			static float random_interval = 0.0f;
-			static bool is_alive = true; // Tracks alive/dead
-			static std::default_random_engine rng(std::random_device{}());
-			static std::uniform_real_distribution<float> interval_distribution(500.0f, 2000.0f);
+	case CLIP_GATE::ON_GROUND:
+		gate_open = player.is_on_ground;
+		break;
+	case CLIP_GATE::IN_AIR:
+		gate_open = !player.is_on_ground;
+		break;
+	case CLIP_GATE::REFLECTING:
+		gate_open = player.reflect_active;
+		break;
+	case CLIP_GATE::DEAD:
+		gate_open = player.is_dead;
+		break;
+	default:
+		break;
+	}
 
-			toggle_timer += elapsed_ms;
+	// skins with two sheets flip between them at random intervals
+	static float toggle_timer = 0.0f;
+	static float random_interval = 0.0f;
+	static bool flicker = false;
+	if (clip->flicker_texture != clip->texture)
+	{
+		static std::default_random_engine rng(std::random_device{}());
+		static std::uniform_real_distribution<float> interval_distribution(500.0f, 2000.0f);
 
-			// random interval
-			if (random_interval == 0.0f)
-			{
-				random_interval = interval_distribution(rng);
-			}
+		toggle_timer += elapsed_ms;
 
-			// toggling only after the interval has elapsed
-			if (toggle_timer >= random_interval)
-			{
-				is_alive = !is_alive;
+		// random interval
+		if (random_interval == 0.0f)
+			random_interval = interval_distribution(rng);
 
-				// reset the timer and MAKE a new random interval
-				toggle_timer = 0.0f;
-				random_interval = interval_distribution(rng);
-			}
-			switch (animation.type)
-			{
-			case IDLE:
-				if (player.is_on_ground)
-					setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-								 GEOMETRY_BUFFER_ID::CAT_IDLE,
-								 is_alive ? TEXTURE_ASSET_ID::CAT_IDLE_SCH_ALIVE : TEXTURE_ASSET_ID::CAT_IDLE_SCH_DEAD,
-								 CAT_IDLE_WALK_FRAME, frame_width);
-				updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-				break;
-
-			case WALK:
-				if (player.is_on_ground)
-					setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-								 GEOMETRY_BUFFER_ID::CAT_WALK,
-								 is_alive ? TEXTURE_ASSET_ID::CAT_WALK_SCH_ALIVE : TEXTURE_ASSET_ID::CAT_WALK_SCH_DEAD,
-								 CAT_IDLE_WALK_FRAME, frame_width);
-				updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-				break;
-
-			case JUMP:
-				if (!player.is_on_ground)
-					setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-								 GEOMETRY_BUFFER_ID::CAT_JUMP,
-								 is_alive ? TEXTURE_ASSET_ID::CAT_JUMP_SCH_ALIVE : TEXTURE_ASSET_ID::CAT_JUMP_SCH_DEAD,
-								 CAT_JUMP_FRAME, frame_width);
-				updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_JUMP_FRAME, 1, false);
-				break;
-
-			case SPIN:
-				if (player.reflect_active)
-					setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-								 GEOMETRY_BUFFER_ID::CAT_SPIN,
-								 is_alive ? TEXTURE_ASSET_ID::CAT_SPIN_SCH_ALIVE : TEXTURE_ASSET_ID::CAT_SPIN_SCH_DEAD,
-								 CAT_SPIN_FRAME, frame_width);
-				updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_SPIN_FRAME, 50, false);
-				break;
-			case DEATH:
-				if (player.is_dead)
-					setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-								 GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH_SCH, 1, frame_width);
-				return;
-			default:
-				break;
-			}
-			break;
-		}
-	case Skin::CAT_SKIN_RAINBOW:
-		switch (animation.type)
+		// toggling only after the interval has elapsed
+		if (toggle_timer >= random_interval)
 		{
-		case IDLE:
-			if (player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_IDLE, TEXTURE_ASSET_ID::CAT_IDLE_RAINBOW, CAT_IDLE_WALK_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-			break;
-
-		case WALK:
-			if (player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_WALK, TEXTURE_ASSET_ID::CAT_WALK_RAINBOW, CAT_IDLE_WALK_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_IDLE_WALK_FRAME, 100, true);
-			break;
-
-		case JUMP:
-			if (!player.is_on_ground)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_JUMP, TEXTURE_ASSET_ID::CAT_JUMP_RAINBOW, CAT_JUMP_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_JUMP_FRAME, 1, false);
-			break;
-		case SPIN:
-			if (player.reflect_active)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_SPIN, TEXTURE_ASSET_ID::CAT_SPIN_RAINBOW, CAT_SPIN_FRAME,
-							 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, CAT_SPIN_FRAME, 50, false);
-			break;
-		case DEATH:
-			if (player.is_dead)
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::CAT_DEATH, TEXTURE_ASSET_ID::CAT_DEATH_RAINBOW, 1, frame_width);
-			return;
-		default:
-			break;
+			flicker = !flicker;
+
+			// reset the timer and MAKE a new random interval
+			toggle_timer = 0.0f;
+			random_interval = interval_distribution(rng);
 		}
-		break;
 	}
-	frame_current = animation.frame_current;
+
+	playClip(entity, *clip, gate_open, flicker, elapsed_ms, frame);
 }
 
 // handle enemy animation
-void AnimationSystem::handleEnemyAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width)
+void AnimationSystem::handleEnemyAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame)
 {
 	// enemy bullets do not have animation
 	//if (registry.enemyBullets.has(entity))
 	//	return;
-	
-	auto &enemy = registry.enemies.get(entity);
-	auto &animation = registry.animations.get(entity);	
-	auto &renderRequest = registry.renderRequests.get(entity);
 
-	animation.frame_counter -= elapsed_ms;
-	int animation_type = animation.type;
+	auto &enemy = registry.enemies.get(entity);
+	auto &animation = registry.animations.get(entity);
 
+	ANIMATED_KIND kind;
 	switch (enemy.enemy_type)
 	{
 	case ENEMY_TYPE::FLYER:
 	case ENEMY_TYPE::BOID:
-		switch (animation.type)
-		{
-		case IDLE:
-			setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-						 GEOMETRY_BUFFER_ID::ENEMY_FLYER, TEXTURE_ASSET_ID::ENEMY_FLYER, ENEMY_FLYER_IDLE_FRAME,
-						 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, ENEMY_FLYER_IDLE_FRAME, 75, true);
-			break;
-
-		case DEATH:
-			setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-						 GEOMETRY_BUFFER_ID::ENEMY_FLYER_DEATH, TEXTURE_ASSET_ID::ENEMY_FLYER_DEATH,
-						 ENEMY_FLYER_DEATH_FRAME, frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, ENEMY_FLYER_DEATH_FRAME, 100, false);
-			break;
-		default:
-			assert(false, "animation not supported");
-			break;
-		}
+		kind = ANIMATED_KIND::ENEMY_FLYER;
 		break;
 	case ENEMY_TYPE::CHARGER:
-		switch (animation.type)
-		{
-		case IDLE:
-			setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-						 GEOMETRY_BUFFER_ID::ENEMY_CHARGER, TEXTURE_ASSET_ID::ENEMY_CHARGER, ENEMY_CHARGER_IDLE_FRAME,
-						 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, ENEMY_CHARGER_IDLE_FRAME, 75, true);
-			break;
-
-		case ATTACK:
-			setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-						 GEOMETRY_BUFFER_ID::ENEMY_CHARGER_ATTACK, TEXTURE_ASSET_ID::ENEMY_CHARGER_ATTACK, ENEMY_CHARGER_ATTACK_FRAME,
-						 frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, ENEMY_CHARGER_ATTACK_FRAME, 75, true);
-			break;
-
-		case DEATH:
-			setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-						 GEOMETRY_BUFFER_ID::ENEMY_CHARGER_DEATH, TEXTURE_ASSET_ID::ENEMY_CHARGER_DEATH,
-						 ENEMY_CHARGER_DEATH_FRAME, frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, ENEMY_CHARGER_DEATH_FRAME, 100, false);
-			break;
-		default:
-			assert(false, "animation not supported");
-			break;
-		}
+		kind = ANIMATED_KIND::ENEMY_CHARGER;
 		break;
 	case ENEMY_TYPE::BOSS:
-		switch (animation.type)
-		{
-		case IDLE:
-		
-			setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-						 GEOMETRY_BUFFER_ID::ENEMY_BOSS_IDLE, TEXTURE_ASSET_ID::ENEMY_BOSS_IDLE, ENEMY_BOSS_IDLE_FRAME,
-						 frame_width);
-
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, ENEMY_BOSS_IDLE_FRAME, 100, true);
-			break;
-		case DEATH:
-			setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-						 GEOMETRY_BUFFER_ID::ENEMY_BOSS_DEATH, TEXTURE_ASSET_ID::ENEMY_BOSS_DEATH,
-						 ENEMY_BOSS_DEATH_FRAME, frame_width);
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, ENEMY_BOSS_DEATH_FRAME, 100, false);
-			break;
-		case JUMP:
-			setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-						 GEOMETRY_BUFFER_ID::ENEMY_BOSS_JUMP, TEXTURE_ASSET_ID::ENEMY_BOSS_JUMP, ENEMY_BOSS_JUMP_FRAME,
-						 frame_width);
-
-			updateAnimationFrame(animation.frame_counter, animation.frame_current, ENEMY_BOSS_JUMP_FRAME, 1, false);
-			break;
-		default:
-			assert(false, "animation not supported");
-			break;
-		}
+		kind = ANIMATED_KIND::ENEMY_BOSS;
 		break;
 	default:
-		assert(false, "animation not supported");
+		assert(false && "animation not supported");
+		return;
 	}
 
-	frame_current = animation.frame_current;
+	const AnimationClip *clip = findAnimationClip(kind, Skin::DEFAULT, animation.type);
+	assert(clip && "animation not supported");
+	if (clip)
+		playClip(entity, *clip, true, false, elapsed_ms, frame);
 }
 
 
 
 // handle weapon animation
-void AnimationSystem::handleWeaponAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width)
+void AnimationSystem::handleWeaponAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame)
 {
 	auto &weapon = registry.weapons.get(entity);
 	auto &animation = registry.animations.get(entity);
-	auto &renderRequest = registry.renderRequests.get(entity);
-
-	animation.frame_counter -= elapsed_ms;
-
-		switch (animation.type)
-		{
-		case IDLE:
-			if (weapon.weapon_type == RIFLE)
-			{
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::RIFLE_IDLE, TEXTURE_ASSET_ID::RIFLE_IDLE, 1, frame_width);
-				updateAnimationFrame(animation.frame_counter, animation.frame_current, WEAPON_ATTACK_FRAME, 1, false);
-			}
-			else if (weapon.weapon_type == GRENADE_LAUNCHER)
-			{
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-									 GEOMETRY_BUFFER_ID::GRENADE_LAUNCHER_IDLE, TEXTURE_ASSET_ID::GRENADE_LAUNCHER_IDLE, 1, frame_width);
-				updateAnimationFrame(animation.frame_counter, animation.frame_current, 1, 1, false);
-			}
 
-			break;
+	const AnimationClip *clip = nullptr;
+	if (weapon.weapon_type == RIFLE)
+		clip = findAnimationClip(ANIMATED_KIND::RIFLE, Skin::DEFAULT, animation.type);
+	else if (weapon.weapon_type == GRENADE_LAUNCHER)
+		clip = findAnimationClip(ANIMATED_KIND::GRENADE_LAUNCHER, Skin::DEFAULT, animation.type);
 
-		case ATTACK:
-			if (weapon.weapon_type == RIFLE)
-			{
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::RIFLE_ATTACK, TEXTURE_ASSET_ID::RIFLE_ATTACK, 5, frame_width);
-				updateAnimationFrame(animation.frame_counter, animation.frame_current, WEAPON_ATTACK_FRAME, 45, false);
-			}
-			else if (weapon.weapon_type == GRENADE_LAUNCHER)
-			{
-				setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-							 GEOMETRY_BUFFER_ID::GRENADE_LAUNCHER_ATTACK, TEXTURE_ASSET_ID::GRENADE_LAUNCHER_ATTACK,
-							 GRENADE_LAUNCHER_ATTACK_FRAME,
-							 frame_width);
-				updateAnimationFrame(animation.frame_counter, animation.frame_current, GRENADE_LAUNCHER_ATTACK_FRAME,
-									 45, false);
-			}
-		default:
-			break;
-		}
-
-	frame_current = animation.frame_current;
+	if (clip)
+		playClip(entity, *clip, true, false, elapsed_ms, frame);
+	else
+	{
+		frame.frame_current = animation.frame_current;
+		frame.clip_frames = 0;
+	}
 }
 
-void AnimationSystem::handleGrenadeAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width)
+void AnimationSystem::handleGrenadeAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame)
 {
 	auto &grenade = registry.grenades.get(entity);
 	auto &animation = registry.animations.get(entity);
-	auto &renderRequest = registry.renderRequests.get(entity);
 	auto &motion = registry.motions.get(entity);
-	
 
-	animation.frame_counter -= elapsed_ms;
-
-	if (animation.type == EXPLODE)
+	const AnimationClip *clip = findAnimationClip(ANIMATED_KIND::GRENADE, Skin::DEFAULT, animation.type);
+	if (!clip)
 	{
-		motion.angle = 0;
-		setAnimation(renderRequest.used_geometry, renderRequest.used_texture, animation.frame_current,
-					 GEOMETRY_BUFFER_ID::GRENADE_EXPLODE, TEXTURE_ASSET_ID::GRENADE_EXPLODE, GRENADE_EXPLODE_FRAME,
-					 frame_width);
-		updateAnimationFrame(animation.frame_counter, animation.frame_current, GRENADE_EXPLODE_FRAME, 25, false);
+		frame.frame_current = animation.frame_current;
+		frame.clip_frames = 0;
+		return;
 	}
-	frame_current = animation.frame_current;
 
-	if (frame_current == GRENADE_EXPLODE_FRAME - 1)
+	motion.angle = 0;
+	playClip(entity, *clip, true, false, elapsed_ms, frame);
+
+	if (frame.frame_current == clip->frames - 1)
 	{
 		grenade.exploded = true;
 	}
-	
 }
 
 // set animation along with corresponding geometry and texture
 void AnimationSystem::setAnimation(GEOMETRY_BUFFER_ID &currGeometry, TEXTURE_ASSET_ID &currTexture, int &currFrame,
-								   GEOMETRY_BUFFER_ID targetGeometry, TEXTURE_ASSET_ID targetTexture, int total_frames,
-								   GLfloat &frame_width)
+								   GEOMETRY_BUFFER_ID targetGeometry, TEXTURE_ASSET_ID targetTexture)
 {
 	if (currGeometry != targetGeometry)
 	{
@@ -472,27 +308,24 @@ void AnimationSystem::setAnimation(GEOMETRY_BUFFER_ID &currGeometry, TEXTURE_ASS
 		currGeometry = targetGeometry;
 		currTexture = targetTexture;
 	}
-	frame_width = 1.f / total_frames;
 }
 
-// with loop
+// with loop, frame_counter may be several frames behind after skipped steps
 void AnimationSystem::updateAnimationFrame(float &frame_counter, int &currFrame, int total_frame, int frame_time,
 										   bool loop = true)
 {
 	if (frame_counter <= 0)
 	{
+		int steps = 1 + (int)(-frame_counter / frame_time);
 		if (loop)
 		{
-			currFrame = (currFrame + 1) % total_frame;
+			currFrame = (currFrame + steps) % total_frame;
 		}
 		else
 		{
-			if (currFrame < total_frame - 1)
-			{
-				currFrame++;
-			}
+			currFrame = std::min(currFrame + steps, total_frame - 1);
 		}
-		frame_counter = frame_time;
+		frame_counter += steps * frame_time;
 	}
 }
 
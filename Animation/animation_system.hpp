@@ -2,40 +2,89 @@
 #include "common.hpp"
 #include "engine/components.hpp"
 #include "engine/tiny_ecs_registry.hpp"
+#include "engine/sparse_set.hpp"
 #include "world/world_system.hpp"
+#include "animation_clips.hpp"
+
+// stlib
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+// Sprite sheet frame of one animated entity as resolved by the last animation step, where
+// the frame is on the sheet follows from the render request's geometry, see
+// animationGeometryFrames
+struct AnimationFrame
+{
+	int frame_current = 0;
+
+	// Looping clips are not advanced on the CPU, the vertex shader picks their frame from
+	// these. clip_frames is 0 while frame_current is used as is.
+	int clip_frames = 0;
+	float clip_start = 0.f; // AnimationSystem::time_ms the clip started at
+	float clip_frame_time = 0.f; // ms
+	bool clip_loop = false;
+
+	// time of the steps this entity skipped, caught up by its next update
+	float pending_ms = 0.f;
+};
+
+// frame a shader driven clip shows at time_ms, the same formula as animated_sprite.vs.glsl
+inline int clipFrameAt(const AnimationFrame &frame, float time_ms)
+{
+	int frame_index = (int)(std::max(time_ms - frame.clip_start, 0.f) / frame.clip_frame_time);
+	return frame.clip_loop ? frame_index % frame.clip_frames : std::min(frame_index, frame.clip_frames - 1);
+}
+
+// written by AnimationSystem::step only, the renderer reads it when preparing a frame
+extern SparseComponentContainer<AnimationFrame> animation_frames;
+
+// How often an animation is updated, by its distance to the screen
+enum class ANIMATION_LOD
+{
+	FULL, // on screen, or needed by gameplay
+	REDUCED, // close to the screen, every AnimationSystem::REDUCED_INTERVAL steps
+	SUSPENDED // far off screen, waits until it comes closer
+};
+
+// Updates done and skipped by the animation steps so far, never reset
+struct AnimationLodStats
+{
+	std::atomic<uint64_t> updated{0};
+	std::atomic<uint64_t> reduced_skipped{0};
+	std::atomic<uint64_t> suspended_skipped{0};
+};
+
+extern AnimationLodStats animation_lod_stats;
 
 // Animation system
 class AnimationSystem
 {
 public:
-	// Variables
-	static const int CAT_IDLE_WALK_FRAME = 6;
-	static const int CAT_JUMP_FRAME = 1;
-	static const int ENEMY_BOSS_IDLE_FRAME = 10;
-	static const int ENEMY_BOSS_JUMP_FRAME = 1;
-	static const int ENEMY_BOSS_DEATH_FRAME = 18;
-	static const int ENEMY_FLYER_IDLE_FRAME = 8;
-	static const int ENEMY_FLYER_DEATH_FRAME = 9;
-	static const int ENEMY_CHARGER_IDLE_FRAME = 6;
-	static const int ENEMY_CHARGER_ATTACK_FRAME = 6;
-	static const int ENEMY_CHARGER_DEATH_FRAME = 9;
-	static const int WEAPON_ATTACK_FRAME = 5;
-	static const int GRENADE_LAUNCHER_ATTACK_FRAME = 7;
-	static const int GRENADE_EXPLODE_FRAME = 12;
-	static const int CAT_SPIN_FRAME = 9;
-	
-
-	static void applyAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width,
-							    WorldSystem &world);
-	static void handlePlayerAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width,
-									  WorldSystem &world);
-	static void handleEnemyAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width);
-	static void handleWeaponAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width);
-	static void handleGrenadeAnimation(Entity entity, float elapsed_ms, int &frame_current, GLfloat &frame_width);
+	// Once per simulation tick: advance every entity in registry.animations and store the
+	// resulting frame in animation_frames
+	static void step(float elapsed_ms, WorldSystem &world);
+	// ms of animation, advanced by step. Shader driven clips are timed against it.
+	static float time_ms;
+
+	// Animations within this many px of the screen update every REDUCED_INTERVAL steps,
+	// further away they are suspended. Skipped time is caught up on the next update.
+	static constexpr float REDUCED_MARGIN_PX = 512.f;
+	static constexpr unsigned int REDUCED_INTERVAL = 4;
+	static ANIMATION_LOD lodOf(Entity entity, vec2 view_min, vec2 view_max);
+
+	static void applyAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame, WorldSystem &world);
+	static void handlePlayerAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame, WorldSystem &world);
+	static void handleEnemyAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame);
+	static void handleWeaponAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame);
+	static void handleGrenadeAnimation(Entity entity, float elapsed_ms, AnimationFrame &frame);
+
+	// one lookup in animation_clips per update
+	static void playClip(Entity entity, const AnimationClip &clip, bool gate_open, bool flicker, float elapsed_ms,
+						 AnimationFrame &frame);
 
 	static void setAnimation(GEOMETRY_BUFFER_ID &currGeometry, TEXTURE_ASSET_ID &currTexture, int &currFrame,
-							 GEOMETRY_BUFFER_ID targetGeometry, TEXTURE_ASSET_ID targetTexture, int total_frames,
-							 GLfloat &frame_width);
+							 GEOMETRY_BUFFER_ID targetGeometry, TEXTURE_ASSET_ID targetTexture);
 
 	static void updateAnimationFrame(float &frame_counter, int &currFrame, int total_frame, int frame_time, bool loop);
 
@@ -1,6 +1,8 @@
 #include "hud_system.hpp"
 #include "engine/tiny_ecs_registry.hpp"
 #include "renderer/render_system.hpp"
+#include "engine/transform_hierarchy.hpp"
+#include "engine/entity_handle.hpp"
 
 // Define the global UI_System instance
 HUD_System HUD_system;
@@ -14,6 +16,8 @@ void HUD_System::initializeHUD(int health_count)
 	{
 		vec2 position = {i * 45.0f - window_width_px / 2 + 135, -window_height_px / 2 + 80};
 		Entity health_icon = createHealthIcon(position, HEALTH_ICON_SIZE);
+		// the icons move with the container
+		transform_hierarchy.attach(health_icon, hud_container, position - registry.motions.get(hud_container).position);
 		health_icons.push_back(health_icon);
 	}
 
@@ -50,6 +54,7 @@ void HUD_System::updateHealthHUD(int new_health)
 		// Remove the last icon in the vector and delete its entity
 		Entity last_icon = health_icons.back();
 		registry.remove_all_components_of(last_icon);
+		entity_handles.release(last_icon);
 		health_icons.pop_back();
 	}
 }
@@ -93,6 +98,9 @@ void HUD_System::initializeBossHealthBar()
 
 	registry.huds.emplace(boss_health_bar);
 	registry.huds.emplace(boss_health_background);
+
+	// the bar shrinks in place on top of its background
+	transform_hierarchy.attach(boss_health_bar, boss_health_background, {0.f, 0.f});
 }
 
 void HUD_System::updateBossHealthBar(int current_health, int max_health)
@@ -113,6 +121,9 @@ void HUD_System::removeBossHealthBar()
 {
 	registry.remove_all_components_of(boss_health_bar);
 	registry.remove_all_components_of(boss_health_background);
+	// the bar hangs from the background through a handle
+	entity_handles.release(boss_health_bar);
+	entity_handles.release(boss_health_background);
 }
 
 void HUD_System::createHUDContainer()
@@ -0,0 +1,45 @@
+#include "destruction_queue.hpp"
+#include "engine/entity_handle.hpp"
+#include "engine/registry_containers.hpp"
+
+// stlib
+#include <algorithm>
+
+DestructionQueue destruction_queue;
+
+void DestructionQueue::push(Entity entity)
+{
+	if (queued.insert(entity).second)
+		pending.push_back(entity);
+}
+
+bool DestructionQueue::is_pending(Entity entity) const
+{
+	return queued.count(entity) > 0;
+}
+
+void DestructionQueue::flush(ECSRegistry &reg)
+{
+	if (pending.empty())
+		return;
+
+	// removing in id order keeps the resulting component order the same from run to run,
+	// no matter in which order the systems queued the entities
+	std::sort(pending.begin(), pending.end(),
+			  [](Entity a, Entity b) { return (unsigned int)a < (unsigned int)b; });
+
+	// the whole batch out of one container before moving to the next, instead of every
+	// container once per entity, most containers are empty and skipped outright
+	for (ContainerInterface *container : registry_containers(reg))
+	{
+		if (container->size() == 0)
+			continue;
+		for (Entity entity : pending)
+			container->remove(entity);
+	}
+	for (Entity entity : pending)
+		entity_handles.release(entity);
+
+	pending.clear();
+	queued.clear();
+}
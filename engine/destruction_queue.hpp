@@ -0,0 +1,35 @@
+#pragma once
+
+// internal
+#include "engine/tiny_ecs_registry.hpp"
+
+// stlib
+#include <unordered_set>
+#include <vector>
+
+// Entities to remove from the registry at the next sync point. Systems push here instead of
+// calling remove_all_components_of while they iterate a component array, so the arrays do
+// not get reordered under them (remove swaps the last component into the freed slot).
+class DestructionQueue
+{
+public:
+	// Queue an entity for removal, queueing it again is a no-op
+	void push(Entity entity);
+
+	// Queued and not removed yet, usually means "ignore this entity"
+	bool is_pending(Entity entity) const;
+
+	// Remove every queued entity from the registry, container by container, and release their
+	// handles
+	void flush(ECSRegistry &reg);
+
+	size_t size() const { return pending.size(); }
+
+private:
+	// queue order, each entity once
+	std::vector<Entity> pending;
+	// ids of pending, is_pending is asked for every collision
+	std::unordered_set<unsigned int> queued;
+};
+
+extern DestructionQueue destruction_queue;
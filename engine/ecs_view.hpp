@@ -0,0 +1,133 @@
+#pragma once
+
+// internal
+#include "engine/tiny_ecs.hpp"
+
+// stlib
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+// Iterates the entities that have a component in every one of a set of containers, e.g.
+//
+//   view(registry.motions, registry.enemies).without(registry.deathTimers).each(
+//       [](Entity entity, Motion &motion, Enemy &enemy) { ... });
+//
+// each() walks the smallest container and probes the others, each_ordered() walks the
+// first container so entities come out in its order (draw order for renderRequests).
+// Do not remove entities from the containers inside the callback, queue them in
+// destruction_queue instead.
+template <typename... Containers>
+class View
+{
+public:
+	static constexpr size_t MAX_EXCLUDED = 4;
+
+	explicit View(Containers &...containers) : containers(containers...) {}
+
+	// Skip entities that also have a component in this container
+	View &without(ContainerInterface &container)
+	{
+		assert(excluded_count < MAX_EXCLUDED && "too many excluded containers in view");
+		excluded[excluded_count++] = &container;
+		return *this;
+	}
+
+	template <typename Fn>
+	void each(Fn &&fn)
+	{
+		size_t driver = smallest(std::index_sequence_for<Containers...>{});
+		iterate(driver, fn, std::index_sequence_for<Containers...>{});
+	}
+
+	template <typename Fn>
+	void each_ordered(Fn &&fn)
+	{
+		iterate(0, fn, std::index_sequence_for<Containers...>{});
+	}
+
+private:
+	template <size_t... I>
+	size_t smallest(std::index_sequence<I...>)
+	{
+		size_t sizes[] = {std::get<I>(containers).size()...};
+		size_t driver = 0;
+		for (size_t i = 1; i < sizeof...(I); i++)
+		{
+			if (sizes[i] < sizes[driver])
+				driver = i;
+		}
+		return driver;
+	}
+
+	template <size_t I>
+	bool has_component(size_t driver, Entity entity)
+	{
+		return I == driver || std::get<I>(containers).has(entity);
+	}
+
+	template <size_t I>
+	auto &component(size_t driver, size_t index, Entity entity)
+	{
+		auto &container = std::get<I>(containers);
+		return I == driver ? container.components[index] : container.get(entity);
+	}
+
+	bool is_excluded(Entity entity)
+	{
+		for (size_t i = 0; i < excluded_count; i++)
+		{
+			if (excluded[i]->has(entity))
+				return true;
+		}
+		return false;
+	}
+
+	// size and entities of the container picked at runtime
+	template <size_t I = 0>
+	size_t driver_size(size_t driver)
+	{
+		if constexpr (I + 1 < sizeof...(Containers))
+		{
+			if (I != driver)
+				return driver_size<I + 1>(driver);
+		}
+		return std::get<I>(containers).size();
+	}
+
+	template <size_t I = 0>
+	Entity driver_entity(size_t driver, size_t index)
+	{
+		if constexpr (I + 1 < sizeof...(Containers))
+		{
+			if (I != driver)
+				return driver_entity<I + 1>(driver, index);
+		}
+		return std::get<I>(containers).entities[index];
+	}
+
+	template <typename Fn, size_t... I>
+	void iterate(size_t driver, Fn &fn, std::index_sequence<I...>)
+	{
+		size_t count = driver_size(driver);
+		for (size_t index = 0; index < count; index++)
+		{
+			Entity entity = driver_entity(driver, index);
+			if (!(has_component<I>(driver, entity) && ...) || is_excluded(entity))
+				continue;
+
+			fn(entity, component<I>(driver, index, entity)...);
+		}
+	}
+
+	std::tuple<Containers &...> containers;
+	ContainerInterface *excluded[MAX_EXCLUDED] = {};
+	size_t excluded_count = 0;
+};
+
+template <typename... Containers>
+View<Containers...> view(Containers &...containers)
+{
+	return View<Containers...>(containers...);
+}
@@ -0,0 +1,69 @@
+#include "entity_handle.hpp"
+
+// stlib
+#include <cassert>
+
+EntityHandles entity_handles;
+
+EntityHandle EntityHandles::acquire(Entity entity)
+{
+	if (slot_of.has(entity))
+	{
+		uint32_t index = slot_of.get(entity);
+		return {index, slots[index].generation};
+	}
+
+	uint32_t index;
+	if (free_slots.empty())
+	{
+		index = (uint32_t)slots.size();
+		slots.push_back({entity, 0, true});
+	}
+	else
+	{
+		index = free_slots.back();
+		free_slots.pop_back();
+		// the generation was bumped when the slot was released
+		slots[index].entity = entity;
+		slots[index].used = true;
+	}
+	slot_of.insert(entity, index);
+	return {index, slots[index].generation};
+}
+
+void EntityHandles::release(Entity entity)
+{
+	if (!slot_of.has(entity))
+		return;
+
+	uint32_t index = slot_of.get(entity);
+	slots[index].generation++;
+	slots[index].used = false;
+	free_slots.push_back(index);
+	slot_of.remove(entity);
+}
+
+bool EntityHandles::is_alive(EntityHandle handle) const
+{
+	return handle.index < slots.size() && slots[handle.index].used &&
+		   slots[handle.index].generation == handle.generation;
+}
+
+Entity EntityHandles::get(EntityHandle handle) const
+{
+	assert(is_alive(handle) && "Stale entity handle");
+	return slots[handle.index].entity;
+}
+
+void EntityHandles::clear()
+{
+	free_slots.clear();
+	for (uint32_t i = 0; i < (uint32_t)slots.size(); i++)
+	{
+		if (slots[i].used)
+			slots[i].generation++;
+		slots[i].used = false;
+		free_slots.push_back(i);
+	}
+	slot_of.clear();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// internal
+#include "engine/sparse_set.hpp"
+
+// stlib
+#include <cstdint>
+#include <vector>
+
+// A reference to an entity that can be kept across frames. index picks a slot of
+// entity_handles and generation has to match the slot's: releasing the entity bumps the
+// slot's generation and frees the slot, so an old handle resolves to nothing even after the
+// slot went to another entity.
+struct EntityHandle
+{
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+	uint32_t index = INVALID_INDEX;
+	uint32_t generation = 0;
+};
+
+// Slot allocator behind EntityHandle, freed slots are reused through a free list
+class EntityHandles
+{
+public:
+	// The handle of entity, its first call allocates a slot
+	EntityHandle acquire(Entity entity);
+	// Every handle of entity goes stale. Call it where the entity is removed from the
+	// registry, a no-op for entities nobody took a handle of.
+	void release(Entity entity);
+
+	bool is_alive(EntityHandle handle) const;
+	// the entity of a live handle
+	Entity get(EntityHandle handle) const;
+
+	// Release every entity, the slots stay so old handles stay stale
+	void clear();
+	size_t size() const { return slots.size() - free_slots.size(); }
+
+private:
+	struct Slot
+	{
+		Entity entity;
+		uint32_t generation;
+		bool used;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> free_slots;
+	// slot of every entity that has a handle
+	SparseComponentContainer<uint32_t> slot_of;
+};
+
+// Copied into checkpoints together with the state that holds handles
+extern EntityHandles entity_handles;
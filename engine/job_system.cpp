@@ -0,0 +1,297 @@
+#include "job_system.hpp"
+
+// stlib
+#include <algorithm>
+#include <cstdlib>
+
+JobSystem job_system;
+
+namespace {
+	// queue of the current thread, 0 for every thread that is not a worker
+	thread_local unsigned int current_queue = 0;
+}
+
+bool SystemAccess::conflicts_with(const SystemAccess &other) const
+{
+	auto contains = [](const std::vector<const void *> &list, const void *container)
+	{ return std::find(list.begin(), list.end(), container) != list.end(); };
+
+	for (const void *container : writes)
+	{
+		if (contains(other.reads, container) || contains(other.writes, container))
+			return true;
+	}
+	for (const void *container : other.writes)
+	{
+		if (contains(reads, container))
+			return true;
+	}
+	return false;
+}
+
+JobSystem::~JobSystem()
+{
+	shutdown();
+}
+
+void JobSystem::set_thread_count(unsigned int count)
+{
+	// running workers are stopped, the next job starts the new count
+	shutdown();
+	requested_threads = count;
+}
+
+unsigned int JobSystem::thread_count()
+{
+	ensure_started();
+	return (unsigned int)workers.size();
+}
+
+void JobSystem::ensure_started()
+{
+	if (started.load(std::memory_order_acquire))
+		return;
+	std::lock_guard<std::mutex> lock(start_mutex);
+	if (started.load(std::memory_order_relaxed))
+		return;
+	start();
+	started.store(true, std::memory_order_release);
+}
+
+void JobSystem::start()
+{
+	unsigned int count = requested_threads;
+	if (count == ~0u)
+	{
+		const char *env = std::getenv("GUNCAT_JOB_THREADS");
+		if (env)
+			count = (unsigned int)std::strtoul(env, nullptr, 10);
+		else
+			count = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	}
+
+	for (unsigned int i = 0; i < count + 1; i++)
+		queues.push_back(std::make_unique<WorkerQueue>());
+
+	running.store(true);
+	for (unsigned int i = 0; i < count; i++)
+		workers.emplace_back(&JobSystem::worker_loop, this, i + 1);
+}
+
+void JobSystem::shutdown()
+{
+	std::lock_guard<std::mutex> lock(start_mutex);
+	if (!running.exchange(false))
+		return;
+	wake.notify_all();
+	for (std::thread &worker : workers)
+		worker.join();
+	workers.clear();
+	queues.clear();
+	started.store(false, std::memory_order_release);
+}
+
+unsigned int JobSystem::own_queue() const
+{
+	return current_queue < queues.size() ? current_queue : 0;
+}
+
+JobHandle JobSystem::submit(std::function<void()> work, const std::vector<JobHandle> &dependencies)
+{
+	std::vector<std::function<void()>> chunks;
+	chunks.push_back(std::move(work));
+	return create(std::move(chunks), dependencies);
+}
+
+JobHandle JobSystem::parallel_for(size_t count, size_t min_chunk, std::function<void(size_t, size_t)> work,
+								  const std::vector<JobHandle> &dependencies)
+{
+	ensure_started();
+
+	// a few chunks per thread so stealing can even out uneven chunks
+	size_t max_chunks = (workers.size() + 1) * 4;
+	size_t chunk_count = std::min(max_chunks, (count + std::max<size_t>(min_chunk, 1) - 1) / std::max<size_t>(min_chunk, 1));
+	chunk_count = std::max<size_t>(chunk_count, count > 0 ? 1 : 0);
+
+	auto shared_work = std::make_shared<std::function<void(size_t, size_t)>>(std::move(work));
+	std::vector<std::function<void()>> chunks;
+	chunks.reserve(chunk_count);
+	for (size_t i = 0; i < chunk_count; i++)
+	{
+		size_t begin = count * i / chunk_count;
+		size_t end = count * (i + 1) / chunk_count;
+		chunks.push_back([shared_work, begin, end]() { (*shared_work)(begin, end); });
+	}
+	return create(std::move(chunks), dependencies);
+}
+
+JobHandle JobSystem::create(std::vector<std::function<void()>> chunks, const std::vector<JobHandle> &dependencies)
+{
+	ensure_started();
+
+	JobHandle job = std::make_shared<JobState>();
+	job->chunks = std::move(chunks);
+	job->unfinished.store((int)job->chunks.size());
+	// held until all dependencies are registered so none of them can schedule the job early
+	job->waiting_on.store(1);
+
+	for (const JobHandle &dependency : dependencies)
+	{
+		if (!dependency)
+			continue;
+		std::lock_guard<std::mutex> lock(dependency->continuation_mutex);
+		if (!dependency->finished)
+		{
+			job->waiting_on.fetch_add(1);
+			dependency->continuations.push_back(job);
+		}
+	}
+
+	if (job->waiting_on.fetch_sub(1) == 1)
+		schedule(job);
+	return job;
+}
+
+void JobSystem::schedule(const JobHandle &job)
+{
+	if (job->chunks.empty())
+	{
+		complete(job);
+		return;
+	}
+
+	WorkerQueue &queue = *queues[own_queue()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		for (std::function<void()> &chunk : job->chunks)
+			queue.tasks.push_back({&chunk, job});
+	}
+	queued_tasks.fetch_add((int)job->chunks.size());
+	wake.notify_all();
+}
+
+void JobSystem::finish_chunk(const JobHandle &job)
+{
+	if (job->unfinished.fetch_sub(1) == 1)
+		complete(job);
+}
+
+void JobSystem::complete(const JobHandle &job)
+{
+	std::vector<JobHandle> ready;
+	{
+		std::lock_guard<std::mutex> lock(job->continuation_mutex);
+		job->finished = true;
+		ready.swap(job->continuations);
+	}
+	for (const JobHandle &continuation : ready)
+	{
+		if (continuation->waiting_on.fetch_sub(1) == 1)
+			schedule(continuation);
+	}
+	// the job's closures can hold on to captured data, let go of it now
+	job->chunks.clear();
+}
+
+bool JobSystem::is_finished(const JobHandle &handle)
+{
+	if (!handle)
+		return true;
+	std::lock_guard<std::mutex> lock(handle->continuation_mutex);
+	return handle->finished;
+}
+
+bool JobSystem::run_one(unsigned int queue_index)
+{
+	Task task = {nullptr, nullptr};
+
+	// newest job from our own queue first, it is the most likely to still be in cache
+	{
+		WorkerQueue &own = *queues[queue_index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty())
+		{
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+		}
+	}
+
+	// otherwise steal the oldest job of someone else
+	for (size_t i = 1; !task.work && i < queues.size(); i++)
+	{
+		WorkerQueue &victim = *queues[(queue_index + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+		}
+	}
+
+	if (!task.work)
+		return false;
+
+	queued_tasks.fetch_sub(1);
+	(*task.work)();
+	finish_chunk(task.owner);
+	return true;
+}
+
+void JobSystem::worker_loop(unsigned int index)
+{
+	current_queue = index;
+	while (running.load())
+	{
+		if (run_one(index))
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake.wait_for(lock, std::chrono::milliseconds(2),
+					  [this]() { return queued_tasks.load() > 0 || !running.load(); });
+	}
+}
+
+void JobSystem::wait(const JobHandle &handle)
+{
+	ensure_started();
+
+	while (!is_finished(handle))
+	{
+		if (!run_one(own_queue()))
+			std::this_thread::yield();
+	}
+}
+
+JobHandle FrameJobs::add(const SystemAccess &access, std::function<void()> work)
+{
+	std::vector<JobHandle> dependencies;
+	for (const Entry &entry : entries)
+	{
+		if (access.conflicts_with(entry.access))
+			dependencies.push_back(entry.handle);
+	}
+
+	JobHandle handle = job_system.submit(std::move(work), dependencies);
+	entries.push_back({access, handle});
+	return handle;
+}
+
+void FrameJobs::run_here(const SystemAccess &access, const std::function<void()> &work)
+{
+	for (const Entry &entry : entries)
+	{
+		if (access.conflicts_with(entry.access))
+			job_system.wait(entry.handle);
+	}
+
+	work();
+	// done already, the systems added after it do not have to wait
+	entries.push_back({access, nullptr});
+}
+
+void FrameJobs::wait_all()
+{
+	for (const Entry &entry : entries)
+		job_system.wait(entry.handle);
+	entries.clear();
+}
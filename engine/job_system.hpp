@@ -0,0 +1,143 @@
+#pragma once
+
+// stlib
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Completion state of a submitted job, shared by the job, its parallel_for chunks and the
+// jobs that depend on it
+struct JobState
+{
+	// chunks still running, the job is done at 0
+	std::atomic<int> unfinished{0};
+	// dependencies that have not finished yet, the job is queued at 0
+	std::atomic<int> waiting_on{0};
+	std::vector<std::function<void()>> chunks;
+
+	std::mutex continuation_mutex;
+	std::vector<std::shared_ptr<JobState>> continuations;
+	bool finished = false;
+};
+
+using JobHandle = std::shared_ptr<JobState>;
+
+// Which component containers a system reads and writes, systems that do not write anything
+// the other one touches can run at the same time
+struct SystemAccess
+{
+	std::vector<const void *> reads;
+	std::vector<const void *> writes;
+
+	template <typename Container>
+	SystemAccess &read(const Container &container)
+	{
+		reads.push_back(&container);
+		return *this;
+	}
+
+	template <typename Container>
+	SystemAccess &write(const Container &container)
+	{
+		writes.push_back(&container);
+		return *this;
+	}
+
+	bool conflicts_with(const SystemAccess &other) const;
+};
+
+// Work-stealing job system. Every worker has its own deque, it pops its newest job and
+// steals the oldest job of another worker when it runs dry. The thread calling wait()
+// helps out instead of blocking, so everything also works with zero worker threads.
+class JobSystem
+{
+public:
+	~JobSystem();
+
+	// Number of worker threads besides the main thread, 0 runs every job on the thread that
+	// waits for it. The default is GUNCAT_JOB_THREADS from the environment or one less than
+	// the number of cores. Workers that already run are stopped and the new count starts with
+	// the next job, so no job may be in flight when it is changed.
+	void set_thread_count(unsigned int count);
+	unsigned int thread_count();
+
+	// Run work once all dependencies have finished
+	JobHandle submit(std::function<void()> work, const std::vector<JobHandle> &dependencies = {});
+
+	// Split [0, count) into chunks of at least min_chunk and run work(begin, end) on each
+	JobHandle parallel_for(size_t count, size_t min_chunk, std::function<void(size_t, size_t)> work,
+						   const std::vector<JobHandle> &dependencies = {});
+
+	// Run queued jobs on this thread until handle has finished
+	void wait(const JobHandle &handle);
+
+	static bool is_finished(const JobHandle &handle);
+
+	// Stop the workers, a later job starts them again
+	void shutdown();
+
+private:
+	struct Task
+	{
+		std::function<void()> *work;
+		JobHandle owner;
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void ensure_started();
+	void start();
+	void worker_loop(unsigned int index);
+	JobHandle create(std::vector<std::function<void()>> chunks, const std::vector<JobHandle> &dependencies);
+	void schedule(const JobHandle &job);
+	void finish_chunk(const JobHandle &job);
+	void complete(const JobHandle &job);
+	bool run_one(unsigned int queue_index);
+	unsigned int own_queue() const;
+
+	unsigned int requested_threads = ~0u;
+	// workers and queues are up, start_mutex guards starting and stopping them
+	std::atomic<bool> started{false};
+	std::mutex start_mutex;
+	std::vector<std::thread> workers;
+	// queue 0 belongs to the main thread, queue i to worker i - 1
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+	std::atomic<bool> running{false};
+	std::atomic<int> queued_tasks{0};
+	std::mutex sleep_mutex;
+	std::condition_variable wake;
+};
+
+extern JobSystem job_system;
+
+// The systems of one frame. Each added system waits for the systems added before it whose
+// component access conflicts with its own, the others run alongside.
+class FrameJobs
+{
+public:
+	JobHandle add(const SystemAccess &access, std::function<void()> work);
+	// Like add, but work runs on the calling thread before this returns, for systems that
+	// have to stay on the main thread (GLFW calls). The conflicting systems added before it
+	// are waited for first.
+	void run_here(const SystemAccess &access, const std::function<void()> &work);
+	void wait_all();
+
+private:
+	struct Entry
+	{
+		SystemAccess access;
+		JobHandle handle;
+	};
+	std::vector<Entry> entries;
+};
@@ -0,0 +1,156 @@
+#include "logger.hpp"
+
+// stlib
+#include <cstdarg>
+#include <cstdio>
+
+Logger logger;
+
+namespace {
+	const char *level_names[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+	const char *category_names[] = {"general", "world", "level", "render", "particle", "animation", "menu", "audio"};
+}
+
+Logger::Logger()
+	: enqueue_pos(0), written(0), min_level((int)LOG_LEVEL::DEBUG), category_mask(~0u), dropped(0),
+	  start_time(std::chrono::steady_clock::now()), running(false)
+{
+	static_assert((RING_CAPACITY & (RING_CAPACITY - 1)) == 0, "ring capacity must be a power of two");
+	for (size_t i = 0; i < RING_CAPACITY; i++)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+Logger::~Logger()
+{
+	if (running.exchange(false))
+	{
+		wake.notify_one();
+		drain_thread.join();
+	}
+	// pick up anything logged after the thread stopped
+	while (drain_one())
+		;
+	fflush(stdout);
+	fflush(stderr);
+}
+
+void Logger::set_category_enabled(LOG_CATEGORY category, bool enabled)
+{
+	uint32_t bit = 1u << (uint32_t)category;
+	if (enabled)
+		category_mask.fetch_or(bit, std::memory_order_relaxed);
+	else
+		category_mask.fetch_and(~bit, std::memory_order_relaxed);
+}
+
+void Logger::start()
+{
+	running.store(true);
+	drain_thread = std::thread(&Logger::drain_loop, this);
+}
+
+void Logger::log(LOG_LEVEL level, LOG_CATEGORY category, const char *format, ...)
+{
+	if ((int)level < min_level.load(std::memory_order_relaxed))
+		return;
+	if (!(category_mask.load(std::memory_order_relaxed) & (1u << (uint32_t)category)))
+		return;
+
+	std::call_once(started, &Logger::start, this);
+
+	// claim a slot (bounded MPMC queue, see Vyukov)
+	size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+	Slot *slot;
+	for (;;)
+	{
+		slot = &slots[pos & (RING_CAPACITY - 1)];
+		size_t seq = slot->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+		if (diff == 0)
+		{
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// full, the drain thread is behind
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else
+		{
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->level = level;
+	slot->category = category;
+	slot->timestamp = std::chrono::duration<float>(std::chrono::steady_clock::now() - start_time).count();
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(slot->text, MESSAGE_LENGTH, format, args);
+	va_end(args);
+
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	// errors are rare, get them out right away
+	if (level == LOG_LEVEL::ERR)
+		wake.notify_one();
+}
+
+bool Logger::drain_one()
+{
+	Slot &slot = slots[dequeue_pos & (RING_CAPACITY - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+		return false;
+
+	FILE *out = slot.level >= LOG_LEVEL::WARN ? stderr : stdout;
+	fprintf(out, "[%9.3f] %-5s %-9s %s\n", slot.timestamp, level_names[(int)slot.level],
+			category_names[(int)slot.category], slot.text);
+
+	slot.sequence.store(dequeue_pos + RING_CAPACITY, std::memory_order_release);
+	dequeue_pos++;
+	written.fetch_add(1, std::memory_order_release);
+	return true;
+}
+
+void Logger::drain_loop()
+{
+	uint64_t reported_dropped = 0;
+	while (running.load())
+	{
+		bool wrote = false;
+		while (drain_one())
+			wrote = true;
+
+		uint64_t total_dropped = dropped.load(std::memory_order_relaxed);
+		if (total_dropped != reported_dropped)
+		{
+			fprintf(stderr, "[logger] dropped %llu messages\n", (unsigned long long)(total_dropped - reported_dropped));
+			reported_dropped = total_dropped;
+			wrote = true;
+		}
+
+		// one flush per batch instead of one per line
+		if (wrote)
+		{
+			fflush(stdout);
+			fflush(stderr);
+		}
+
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		wake.wait_for(lock, std::chrono::milliseconds(10));
+	}
+}
+
+void Logger::flush()
+{
+	if (!running.load())
+		return;
+
+	size_t target = enqueue_pos.load(std::memory_order_acquire);
+	wake.notify_one();
+	while (written.load(std::memory_order_acquire) < target)
+		std::this_thread::yield();
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// stlib
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Severity of a log message, lower is more verbose
+enum class LOG_LEVEL
+{
+	DEBUG = 0,
+	INFO = 1,
+	WARN = 2,
+	ERR = 3
+};
+
+// Which part of the game a log message comes from
+enum class LOG_CATEGORY
+{
+	GENERAL = 0,
+	WORLD = 1,
+	LEVEL = 2,
+	RENDER = 3,
+	PARTICLE = 4,
+	ANIMATION = 5,
+	MENU = 6,
+	AUDIO = 7,
+	CATEGORY_COUNT = AUDIO + 1
+};
+
+// Anything below this level is compiled out. Debug logs are stripped from release builds
+// unless GUNCAT_LOG_MIN_LEVEL is set explicitly.
+#ifndef GUNCAT_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define GUNCAT_LOG_MIN_LEVEL 1
+#else
+#define GUNCAT_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+// Formats messages into a lock-free ring buffer, a background thread drains the buffer
+// and writes to the console so the game loop never waits on a flush.
+class Logger
+{
+public:
+	// must be a power of two
+	static constexpr size_t RING_CAPACITY = 1024;
+	static constexpr size_t MESSAGE_LENGTH = 240;
+
+	Logger();
+	~Logger();
+
+	// printf style, never blocks. The message is dropped if the ring buffer is full.
+	void log(LOG_LEVEL level, LOG_CATEGORY category, const char *format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+		__attribute__((format(printf, 4, 5)))
+#endif
+		;
+
+	// Runtime filter on top of the compile time one
+	void set_min_level(LOG_LEVEL level) { min_level.store((int)level, std::memory_order_relaxed); }
+	void set_category_enabled(LOG_CATEGORY category, bool enabled);
+
+	// Blocks until everything logged so far has been written out
+	void flush();
+
+	uint64_t dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		LOG_LEVEL level;
+		LOG_CATEGORY category;
+		float timestamp;
+		char text[MESSAGE_LENGTH];
+	};
+
+	void start();
+	void drain_loop();
+	bool drain_one();
+
+	Slot slots[RING_CAPACITY];
+	std::atomic<size_t> enqueue_pos;
+	// only touched by the drain thread
+	size_t dequeue_pos = 0;
+	std::atomic<size_t> written;
+
+	std::atomic<int> min_level;
+	std::atomic<uint32_t> category_mask;
+	std::atomic<uint64_t> dropped;
+
+	std::chrono::time_point<std::chrono::steady_clock> start_time;
+	std::once_flag started;
+	std::atomic<bool> running;
+	std::thread drain_thread;
+	std::mutex wake_mutex;
+	std::condition_variable wake;
+};
+
+extern Logger logger;
+
+#if GUNCAT_LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(category, ...) logger.log(LOG_LEVEL::DEBUG, category, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) ((void)0)
+#endif
+
+#if GUNCAT_LOG_MIN_LEVEL <= 1
+#define LOG_INFO(category, ...) logger.log(LOG_LEVEL::INFO, category, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) ((void)0)
+#endif
+
+#if GUNCAT_LOG_MIN_LEVEL <= 2
+#define LOG_WARN(category, ...) logger.log(LOG_LEVEL::WARN, category, __VA_ARGS__)
+#else
+#define LOG_WARN(category, ...) ((void)0)
+#endif
+
+#define LOG_ERROR(category, ...) logger.log(LOG_LEVEL::ERR, category, __VA_ARGS__)
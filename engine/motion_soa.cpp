@@ -0,0 +1,148 @@
+#include "motion_soa.hpp"
+#include "engine/job_system.hpp"
+
+// stlib
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GUNCAT_MOTION_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GUNCAT_MOTION_SSE 1
+#endif
+
+void MotionSoA::resize(size_t count)
+{
+	position_x.resize(count);
+	position_y.resize(count);
+	velocity_x.resize(count);
+	velocity_y.resize(count);
+	gravity_scale.resize(count);
+	friction.resize(count);
+}
+
+void MotionSoA::clear()
+{
+	// keep the capacity, the body count is about the same every frame
+	resize(0);
+}
+
+void integrate_motions_scalar(MotionSoA &bodies, const IntegrationParams &params, size_t begin, size_t end)
+{
+	end = std::min(end, bodies.size());
+	float *px = bodies.position_x.data();
+	float *py = bodies.position_y.data();
+	float *vx = bodies.velocity_x.data();
+	float *vy = bodies.velocity_y.data();
+	const float *gs = bodies.gravity_scale.data();
+	const float *fr = bodies.friction.data();
+	const float dt = params.dt;
+	const float gravity_dt = params.gravity * params.dt;
+
+	for (size_t i = begin; i < end; i++)
+	{
+		vy[i] += gravity_dt * gs[i];
+		vx[i] *= std::max(0.f, 1.f - fr[i] * dt);
+		px[i] += vx[i] * dt;
+		py[i] += vy[i] * dt;
+	}
+}
+
+// bodies [begin, end), vectorized where possible
+static void integrate_range(MotionSoA &bodies, const IntegrationParams &params, size_t begin, size_t end)
+{
+	size_t i = begin;
+
+#if defined(GUNCAT_MOTION_AVX) || defined(GUNCAT_MOTION_SSE)
+	float *px = bodies.position_x.data();
+	float *py = bodies.position_y.data();
+	float *vx = bodies.velocity_x.data();
+	float *vy = bodies.velocity_y.data();
+	const float *gs = bodies.gravity_scale.data();
+	const float *fr = bodies.friction.data();
+	const size_t count = end;
+#endif
+
+#if defined(GUNCAT_MOTION_AVX)
+	const __m256 dt = _mm256_set1_ps(params.dt);
+	const __m256 gravity_dt = _mm256_set1_ps(params.gravity * params.dt);
+	const __m256 one = _mm256_set1_ps(1.f);
+	const __m256 zero = _mm256_setzero_ps();
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 v_y = _mm256_add_ps(_mm256_loadu_ps(vy + i), _mm256_mul_ps(gravity_dt, _mm256_loadu_ps(gs + i)));
+		__m256 damping = _mm256_max_ps(zero, _mm256_sub_ps(one, _mm256_mul_ps(_mm256_loadu_ps(fr + i), dt)));
+		__m256 v_x = _mm256_mul_ps(_mm256_loadu_ps(vx + i), damping);
+		_mm256_storeu_ps(vx + i, v_x);
+		_mm256_storeu_ps(vy + i, v_y);
+		_mm256_storeu_ps(px + i, _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(v_x, dt)));
+		_mm256_storeu_ps(py + i, _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(v_y, dt)));
+	}
+#elif defined(GUNCAT_MOTION_SSE)
+	const __m128 dt = _mm_set1_ps(params.dt);
+	const __m128 gravity_dt = _mm_set1_ps(params.gravity * params.dt);
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 v_y = _mm_add_ps(_mm_loadu_ps(vy + i), _mm_mul_ps(gravity_dt, _mm_loadu_ps(gs + i)));
+		__m128 damping = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(_mm_loadu_ps(fr + i), dt)));
+		__m128 v_x = _mm_mul_ps(_mm_loadu_ps(vx + i), damping);
+		_mm_storeu_ps(vx + i, v_x);
+		_mm_storeu_ps(vy + i, v_y);
+		_mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(v_x, dt)));
+		_mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(v_y, dt)));
+	}
+#endif
+
+	// whatever did not fill a whole vector, or everything without SIMD
+	integrate_motions_scalar(bodies, params, i, end);
+}
+
+void integrate_motions(MotionSoA &bodies, const IntegrationParams &params)
+{
+	// a full particle pool (4096) is split in four, smaller batches stay on this thread since
+	// a single core is done with them before the other threads would have woken up
+	const size_t PARALLEL_BODIES = 4096;
+	const size_t BODIES_PER_JOB = 1024;
+	if (bodies.size() < PARALLEL_BODIES || job_system.thread_count() == 0)
+	{
+		integrate_range(bodies, params, 0, bodies.size());
+		return;
+	}
+
+	JobHandle job = job_system.parallel_for(bodies.size(), BODIES_PER_JOB,
+											[&bodies, &params](size_t begin, size_t end)
+											{ integrate_range(bodies, params, begin, end); });
+	job_system.wait(job);
+}
+
+void gather_motions(ECSRegistry &reg, MotionSoA &bodies, float friction)
+{
+	auto &motions = reg.motions;
+	bodies.resize(motions.size());
+	for (size_t i = 0; i < motions.size(); i++)
+	{
+		Entity entity = motions.entities[i];
+		const Motion &motion = motions.components[i];
+		bodies.position_x[i] = motion.position.x;
+		bodies.position_y[i] = motion.position.y;
+		bodies.velocity_x[i] = motion.velocity.x;
+		bodies.velocity_y[i] = motion.velocity.y;
+		bodies.gravity_scale[i] = reg.gravities.has(entity) ? 1.f : 0.f;
+		bodies.friction[i] = reg.frictions.has(entity) ? friction : 0.f;
+	}
+}
+
+void scatter_motions(ECSRegistry &reg, const MotionSoA &bodies)
+{
+	auto &motions = reg.motions;
+	size_t count = std::min(bodies.size(), motions.size());
+	for (size_t i = 0; i < count; i++)
+	{
+		Motion &motion = motions.components[i];
+		motion.position = {bodies.position_x[i], bodies.position_y[i]};
+		motion.velocity = {bodies.velocity_x[i], bodies.velocity_y[i]};
+	}
+}
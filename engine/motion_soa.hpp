@@ -0,0 +1,61 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "engine/tiny_ecs_registry.hpp"
+
+// stlib
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Motion state as one float array per field, so the integration below can work on 4 or 8
+// bodies per instruction. Index i of every array is the same body.
+struct MotionSoA
+{
+	std::vector<float> position_x;
+	std::vector<float> position_y;
+	std::vector<float> velocity_x;
+	std::vector<float> velocity_y;
+	// 1 for bodies affected by gravity, 0 otherwise
+	std::vector<float> gravity_scale;
+	// damping rate of the horizontal velocity in 1/s, 0 for bodies without friction. See
+	// integrate_motions for the model.
+	std::vector<float> friction;
+
+	size_t size() const { return position_x.size(); }
+	void resize(size_t count);
+	void clear();
+};
+
+struct IntegrationParams
+{
+	float dt = 0.f;		 // seconds
+	float gravity = 0.f; // downward acceleration, px/s^2
+};
+
+// v.y += gravity * dt, v.x *= max(0, 1 - friction * dt), p += v * dt for every body, using
+// AVX or SSE when the build targets them and plain loops otherwise. 4096 bodies and more
+// (a full particle pool) are split across the job system's threads.
+//
+// Friction is linear drag on the horizontal velocity, dv/dt = -friction * v, stepped with
+// explicit Euler like the rest. The clamp keeps a large friction * dt from flipping the
+// direction, it stops the body instead. The exact decay would be exp(-friction * dt), so
+// the damping per second shifts a little with the frame time (1% at 60 fps and friction
+// 1.2). Physics code that damps by a fixed factor k per frame instead gets the same result
+// at a fixed frame time with friction = (1 - k) / dt, e.g. k = 0.95 at 60 fps is 3/s. It
+// is not a Coulomb (constant deceleration) model, a body never quite stops on its own.
+// Gameplay bodies still go through the physics system's own friction, only particles use
+// this kernel so far (friction 0).
+void integrate_motions(MotionSoA &bodies, const IntegrationParams &params);
+
+// The scalar version for bodies [begin, end), also handles the tail the vector loops leave over
+void integrate_motions_scalar(MotionSoA &bodies, const IntegrationParams &params, size_t begin = 0,
+							  size_t end = SIZE_MAX);
+
+// Copy position and velocity of every Motion in the registry into bodies (in registry.motions
+// order), with the gravity and friction settings taken from the gravities and frictions
+// containers, and write the result back afterwards. friction is the rate in 1/s every body
+// in frictions gets, see integrate_motions.
+void gather_motions(ECSRegistry &reg, MotionSoA &bodies, float friction);
+void scatter_motions(ECSRegistry &reg, const MotionSoA &bodies);
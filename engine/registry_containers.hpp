@@ -0,0 +1,102 @@
+#pragma once
+
+// internal
+#include "engine/tiny_ecs_registry.hpp"
+
+// stlib
+#include <cstddef>
+#include <vector>
+
+// The containers of ECSRegistry as pointers to members, for code that works on all of them
+// at once (checkpoints, batched removal). fn is called once per container, e.g.
+//
+//   for_each_container([&](auto member) { (reg.*member).clear(); });
+
+// Everything the game state is made of, a checkpoint captures exactly these
+template <typename Fn>
+constexpr void for_each_gameplay_container(Fn &&fn)
+{
+	fn(&ECSRegistry::motions);
+	fn(&ECSRegistry::renderRequests);
+	fn(&ECSRegistry::meshPtrs);
+	fn(&ECSRegistry::colors);
+	fn(&ECSRegistry::opacities);
+	fn(&ECSRegistry::animations);
+	fn(&ECSRegistry::players);
+	fn(&ECSRegistry::healths);
+	fn(&ECSRegistry::gravities);
+	fn(&ECSRegistry::frictions);
+	fn(&ECSRegistry::spinCoolDown);
+	fn(&ECSRegistry::deathTimers);
+	fn(&ECSRegistry::invincibilityTimers);
+	fn(&ECSRegistry::obstacles);
+	fn(&ECSRegistry::backgrounds);
+	fn(&ECSRegistry::weapons);
+	fn(&ECSRegistry::bullets);
+	fn(&ECSRegistry::enemyBullets);
+	fn(&ECSRegistry::grenades);
+	fn(&ECSRegistry::bounces);
+	fn(&ECSRegistry::enemies);
+	fn(&ECSRegistry::flyerEnemies);
+	fn(&ECSRegistry::boidEnemies);
+	fn(&ECSRegistry::chargerEnemies);
+	fn(&ECSRegistry::bossEnemies);
+	fn(&ECSRegistry::enemyHealthBars);
+	fn(&ECSRegistry::patrolBoxes);
+	fn(&ECSRegistry::deadlys);
+	fn(&ECSRegistry::tbox);
+	fn(&ECSRegistry::level_out);
+	fn(&ECSRegistry::alpha_box);
+	fn(&ECSRegistry::endGameTriggers);
+	fn(&ECSRegistry::collectables);
+	fn(&ECSRegistry::texts);
+	fn(&ECSRegistry::huds);
+	fn(&ECSRegistry::particles);
+	fn(&ECSRegistry::crosshairs);
+	fn(&ECSRegistry::debugComponents);
+}
+
+// Never part of a checkpoint: the gameplay camera (it keeps its position across a respawn),
+// the menu's containers and the per frame collisions
+template <typename Fn>
+constexpr void for_each_unsaved_container(Fn &&fn)
+{
+	fn(&ECSRegistry::cameras);
+	fn(&ECSRegistry::screenStates);
+	fn(&ECSRegistry::buttons);
+	fn(&ECSRegistry::collisions);
+}
+
+template <typename Fn>
+constexpr void for_each_container(Fn &&fn)
+{
+	for_each_gameplay_container(fn);
+	for_each_unsaved_container(fn);
+}
+
+constexpr size_t registry_container_count()
+{
+	size_t count = 0;
+	for_each_container([&count](auto) { count++; });
+	return count;
+}
+
+// The registry does not expose how many containers it has, so the count is checked through
+// its size. The equality holds because ECSRegistry has no members but its registry_list and
+// one ComponentContainer per component type. A container is a vtable pointer, a hash map
+// and two vectors whatever its component, all pointer aligned, so there is no padding in
+// between. A container added to (or removed from) the registry without adding it above
+// fails to compile here, and so does any other member added to ECSRegistry: list it in
+// this sum too when that happens.
+static_assert(sizeof(ECSRegistry) == sizeof(std::vector<ContainerInterface *>) +
+										 registry_container_count() * sizeof(ComponentContainer<Motion>),
+			  "ECSRegistry changed, add the new container to registry_containers.hpp");
+
+// Every container of reg as its common base
+inline std::vector<ContainerInterface *> registry_containers(ECSRegistry &reg)
+{
+	std::vector<ContainerInterface *> containers;
+	containers.reserve(registry_container_count());
+	for_each_container([&](auto member) { containers.push_back(&(reg.*member)); });
+	return containers;
+}
@@ -0,0 +1,29 @@
+#include "registry_snapshot.hpp"
+#include "engine/registry_containers.hpp"
+
+RegistrySnapshot::RegistrySnapshot()
+{
+	for_each_gameplay_container([this](auto member) { add(member); });
+}
+
+void RegistrySnapshot::capture(ECSRegistry &reg)
+{
+	for (auto &container : containers)
+		container->capture(reg);
+	captured = true;
+}
+
+void RegistrySnapshot::restore(ECSRegistry &reg) const
+{
+	if (!captured)
+		return;
+	for (const auto &container : containers)
+		container->restore(reg);
+}
+
+void RegistrySnapshot::clear()
+{
+	for (auto &container : containers)
+		container->clear();
+	captured = false;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// internal
+#include "engine/tiny_ecs_registry.hpp"
+
+// stlib
+#include <memory>
+#include <vector>
+
+// Copy of the component containers of the registry that can be put back later, used for
+// checkpoints. Capturing and restoring copy whole containers at once (vector assignment
+// reuses the capacity from the last capture), nothing is rebuilt entity by entity.
+//
+// The menu's containers (screen states, buttons), the per frame collisions and the gameplay
+// camera are not part of the snapshot, see for_each_unsaved_container. Restoring a
+// checkpoint never touches the UI, and the camera is not put back on respawn: it stays
+// where it was when the player died until the camera code moves it to the restored player.
+class RegistrySnapshot
+{
+public:
+	RegistrySnapshot();
+
+	// Copy every gameplay container of reg
+	void capture(ECSRegistry &reg);
+
+	// Put reg back to the state of the last capture. Entities created since then are gone,
+	// entities removed since then are back with the same ids.
+	void restore(ECSRegistry &reg) const;
+
+	bool is_valid() const { return captured; }
+	void clear();
+
+private:
+	struct ContainerCopy
+	{
+		virtual ~ContainerCopy() = default;
+		virtual void capture(ECSRegistry &reg) = 0;
+		virtual void restore(ECSRegistry &reg) const = 0;
+		virtual void clear() = 0;
+	};
+
+	template <typename Component>
+	struct TypedContainerCopy : ContainerCopy
+	{
+		ComponentContainer<Component> ECSRegistry::*member;
+		ComponentContainer<Component> copy;
+
+		explicit TypedContainerCopy(ComponentContainer<Component> ECSRegistry::*member) : member(member) {}
+		void capture(ECSRegistry &reg) override { copy = reg.*member; }
+		void restore(ECSRegistry &reg) const override { reg.*member = copy; }
+		void clear() override { copy.clear(); }
+	};
+
+	template <typename Component>
+	void add(ComponentContainer<Component> ECSRegistry::*member)
+	{
+		containers.push_back(std::make_unique<TypedContainerCopy<Component>>(member));
+	}
+
+	std::vector<std::unique_ptr<ContainerCopy>> containers;
+	bool captured = false;
+};
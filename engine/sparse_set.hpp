@@ -0,0 +1,185 @@
+#pragma once
+
+// internal
+#include "engine/tiny_ecs.hpp"
+
+// stlib
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Drop-in replacement for ComponentContainer backed by a paged sparse set. The components
+// and entities stay in dense arrays like before, the entity -> index map is an array of
+// pages indexed by entity id, so has/get/remove are two array reads and no hashing.
+//
+// Entity ids only ever grow, pages that no longer hold any entity are released so the
+// sparse index does not keep growing with them.
+template <typename Component>
+class SparseComponentContainer : public ContainerInterface
+{
+private:
+	static constexpr uint32_t PAGE_SIZE = 1024; // entries per page, power of two
+	static constexpr uint32_t PAGE_SHIFT = 10;
+	static constexpr uint32_t INVALID = UINT32_MAX;
+
+	// sparse[id >> PAGE_SHIFT][id & (PAGE_SIZE - 1)] is the dense index of entity id,
+	// an empty page means no entity in that range
+	std::vector<std::vector<uint32_t>> sparse;
+	// number of entities stored in each page
+	std::vector<uint32_t> page_counts;
+
+	uint32_t index_of(unsigned int id) const
+	{
+		uint32_t page = id >> PAGE_SHIFT;
+		if (page >= sparse.size() || sparse[page].empty())
+			return INVALID;
+		return sparse[page][id & (PAGE_SIZE - 1)];
+	}
+
+	void set_index(unsigned int id, uint32_t index)
+	{
+		uint32_t page = id >> PAGE_SHIFT;
+		if (page >= sparse.size())
+		{
+			sparse.resize(page + 1);
+			page_counts.resize(page + 1, 0);
+		}
+		if (sparse[page].empty())
+			sparse[page].assign(PAGE_SIZE, INVALID);
+
+		uint32_t &slot = sparse[page][id & (PAGE_SIZE - 1)];
+		if (slot == INVALID)
+			page_counts[page]++;
+		slot = index;
+	}
+
+	void clear_index(unsigned int id)
+	{
+		uint32_t page = id >> PAGE_SHIFT;
+		sparse[page][id & (PAGE_SIZE - 1)] = INVALID;
+		if (--page_counts[page] == 0)
+		{
+			// give the page back, ids in this range are most likely never used again
+			std::vector<uint32_t>().swap(sparse[page]);
+		}
+	}
+
+public:
+	// Container of all components of type 'Component'
+	std::vector<Component> components;
+
+	// The corresponding entities
+	std::vector<Entity> entities;
+
+	SparseComponentContainer() {}
+
+	// Inserting a component c associated to entity e
+	inline Component &insert(Entity e, Component c, bool check_for_duplicates = true)
+	{
+		// Usually, every entity should only have one instance of each component type
+		assert(!(check_for_duplicates && has(e)) && "Entity already contained in ECS registry");
+
+		// with duplicates the index points at the newest component, like the map did
+		set_index(e, (uint32_t)components.size());
+		components.push_back(std::move(c));
+		entities.push_back(e);
+		return components.back();
+	}
+
+	template <typename... Args>
+	Component &emplace(Entity e, Args &&...args)
+	{
+		return insert(e, Component(std::forward<Args>(args)...));
+	}
+
+	template <typename... Args>
+	Component &emplace_with_duplicates(Entity e, Args &&...args)
+	{
+		return insert(e, Component(std::forward<Args>(args)...), false);
+	}
+
+	// A wrapper to return the component of an entity
+	Component &get(Entity e)
+	{
+		uint32_t index = index_of(e);
+		assert(index != INVALID && "Entity not contained in ECS registry");
+		return components[index];
+	}
+
+	// Check if entity has a component of type 'Component'
+	bool has(Entity entity) { return index_of(entity) != INVALID; }
+
+	// Remove an component and pack the container to re-use the empty space
+	void remove(Entity e)
+	{
+		uint32_t index = index_of(e);
+		if (index == INVALID)
+			return;
+
+		uint32_t last = (uint32_t)components.size() - 1;
+		if (index != last)
+		{
+			// Move the last element to the freed slot
+			Entity moved = entities[last];
+			components[index] = std::move(components.back());
+			entities[index] = moved;
+			if (index_of(moved) == last)
+				set_index(moved, index);
+		}
+		clear_index(e);
+		components.pop_back();
+		entities.pop_back();
+	}
+
+	// Remove all components of type 'Component'
+	void clear()
+	{
+		sparse.clear();
+		page_counts.clear();
+		components.clear();
+		entities.clear();
+	}
+
+	// Report the number of components of type 'Component'
+	size_t size() { return components.size(); }
+
+	// Sort the components and associated entity assignment structures by the comparisonFunction,
+	// see std::sort. Only valid without duplicates.
+	template <class Compare>
+	void sort(Compare comparisonFunction)
+	{
+		sort_pairs([&comparisonFunction](const std::pair<Entity, Component> &a, const std::pair<Entity, Component> &b)
+				   { return comparisonFunction(a.first, b.first); });
+	}
+
+	// Like sort, but comparisonFunction is given the components. The container is being
+	// rearranged during the sort, so orders that depend on the components have to use this
+	// instead of looking them up with get().
+	template <class Compare>
+	void sort_by_component(Compare comparisonFunction)
+	{
+		sort_pairs([&comparisonFunction](const std::pair<Entity, Component> &a, const std::pair<Entity, Component> &b)
+				   { return comparisonFunction(a.second, b.second); });
+	}
+
+private:
+	template <class PairCompare>
+	void sort_pairs(PairCompare compare)
+	{
+		std::vector<std::pair<Entity, Component>> pairs;
+		pairs.reserve(components.size());
+		for (size_t i = 0; i < components.size(); i++)
+			pairs.emplace_back(entities[i], std::move(components[i]));
+
+		std::sort(pairs.begin(), pairs.end(), compare);
+
+		for (uint32_t i = 0; i < (uint32_t)pairs.size(); i++)
+		{
+			entities[i] = pairs[i].first;
+			components[i] = std::move(pairs[i].second);
+			set_index(entities[i], i);
+		}
+	}
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+// internal
+#include "engine/tiny_ecs.hpp"
+
+// stlib
+#include <cstddef>
+
+// Removal while walking a container whose remove swaps the last element into the freed
+// slot, which is what every component container and the particle pool do. The walk goes
+// backwards, so the element that gets swapped in has been looked at already.
+
+// Call remove(i) for every i in [0, count) for which pred(i) holds, returns how many
+template <typename Pred, typename Remove>
+size_t swap_remove_if(size_t count, Pred pred, Remove remove)
+{
+	size_t removed = 0;
+	for (size_t i = count; i-- > 0;)
+	{
+		if (pred(i))
+		{
+			remove(i);
+			removed++;
+		}
+	}
+	return removed;
+}
+
+// Remove every entity of container for which pred(entity, component) holds with
+// remove(entity), e.g. registry.remove_all_components_of
+template <typename Container, typename Pred, typename Remove>
+size_t remove_entities_if(Container &container, Pred pred, Remove remove)
+{
+	return swap_remove_if(
+		container.size(), [&](size_t i) { return pred(container.entities[i], container.components[i]); },
+		[&](size_t i) { remove(container.entities[i]); });
+}
+
+// Same, taking the entities out of container only
+template <typename Container, typename Pred>
+size_t remove_entities_if(Container &container, Pred pred)
+{
+	return remove_entities_if(container, pred, [&container](Entity entity) { container.remove(entity); });
+}
@@ -0,0 +1,106 @@
+#include "transform_hierarchy.hpp"
+#include "engine/swap_remove.hpp"
+
+// stlib
+#include <cassert>
+#include <cmath>
+
+TransformHierarchy transform_hierarchy;
+
+namespace {
+	// a parent is gone once its handle went stale, or when it lost its Motion without being
+	// released
+	bool hasParent(ECSRegistry &reg, const Attachment &link)
+	{
+		return entity_handles.is_alive(link.parent) && reg.motions.has(entity_handles.get(link.parent));
+	}
+}
+
+void TransformHierarchy::attach(Entity child, Entity parent, vec2 offset, bool follow_angle)
+{
+	assert((unsigned int)child != (unsigned int)parent && "An entity cannot carry itself");
+
+	// the parent may not hang below the child, that would be a cycle
+	for (Entity ancestor = parent; links.has(ancestor) && entity_handles.is_alive(links.get(ancestor).parent);
+		 ancestor = entity_handles.get(links.get(ancestor).parent))
+		assert((unsigned int)entity_handles.get(links.get(ancestor).parent) != (unsigned int)child &&
+			   "Attachment cycle");
+
+	links.remove(child);
+	Attachment &link = links.emplace(child);
+	link.parent = entity_handles.acquire(parent);
+	link.offset = offset;
+	link.follow_angle = follow_angle;
+	order_dirty = true;
+}
+
+void TransformHierarchy::detach(Entity child)
+{
+	if (!links.has(child))
+		return;
+	links.remove(child);
+	// remove swaps the last (deepest) link into the freed slot
+	order_dirty = true;
+}
+
+void TransformHierarchy::clear()
+{
+	links.clear();
+	order_dirty = false;
+}
+
+void TransformHierarchy::sort_links()
+{
+	for (size_t i = 0; i < links.size(); i++)
+	{
+		int depth = 0;
+		for (EntityHandle ancestor = links.components[i].parent;
+			 entity_handles.is_alive(ancestor) && links.has(entity_handles.get(ancestor));
+			 ancestor = links.get(entity_handles.get(ancestor)).parent)
+			depth++;
+		links.components[i].depth = depth;
+	}
+
+	links.sort_by_component([](const Attachment &a, const Attachment &b) { return a.depth < b.depth; });
+	order_dirty = false;
+}
+
+void TransformHierarchy::update(ECSRegistry &reg)
+{
+	if (order_dirty)
+		sort_links();
+
+	bool lost_links = false;
+	for (size_t i = 0; i < links.size(); i++)
+	{
+		Entity child = links.entities[i];
+		const Attachment &link = links.components[i];
+		if (!reg.motions.has(child) || !hasParent(reg, link))
+		{
+			lost_links = true;
+			continue;
+		}
+
+		const Motion &parent_motion = reg.motions.get(entity_handles.get(link.parent));
+		Motion &child_motion = reg.motions.get(child);
+		if (link.follow_angle)
+		{
+			float c = cos(parent_motion.angle);
+			float s = sin(parent_motion.angle);
+			vec2 turned = {c * link.offset.x - s * link.offset.y, s * link.offset.x + c * link.offset.y};
+			child_motion.position = parent_motion.position + turned;
+			child_motion.angle = parent_motion.angle + link.angle;
+		}
+		else
+		{
+			child_motion.position = parent_motion.position + link.offset;
+		}
+	}
+
+	if (!lost_links)
+		return;
+
+	remove_entities_if(links, [&reg](Entity child, const Attachment &link)
+					   { return !reg.motions.has(child) || !hasParent(reg, link); });
+	order_dirty = true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "engine/entity_handle.hpp"
+#include "engine/sparse_set.hpp"
+#include "engine/tiny_ecs_registry.hpp"
+
+// Link from an entity to the entity that carries it. The child's Motion is derived from the
+// parent's Motion on every sweep, gameplay code only moves the parent.
+struct Attachment
+{
+	// goes stale when the parent is released, the link is dropped then
+	EntityHandle parent;
+	vec2 offset = {0.f, 0.f}; // from the parent's position, px
+	// turn the offset and the child's angle with the parent
+	bool follow_angle = false;
+	float angle = 0.f; // added to the parent's angle when follow_angle is set
+	// number of attached ancestors, the parent of a depth 0 link is not attached itself
+	int depth = 0;
+};
+
+// Parent/child transforms for entities that move with another one (enemy health bars, HUD
+// groups). The links are kept sorted by depth in one dense array, so a single front to back
+// sweep sees every parent's world transform before its children read it.
+class TransformHierarchy
+{
+public:
+	// Attaching again replaces the old link, the child keeps its own scale
+	void attach(Entity child, Entity parent, vec2 offset, bool follow_angle = false);
+	void detach(Entity child);
+
+	bool is_attached(Entity child) { return links.has(child); }
+	// the link of an attached child, to change its offset
+	Attachment &get(Entity child) { return links.get(child); }
+
+	// Write the world position (and angle) of every attached child. Links whose parent is
+	// gone or whose child lost its Motion are dropped.
+	void update(ECSRegistry &reg);
+
+	void clear();
+	size_t size() { return links.size(); }
+
+private:
+	// recompute depths and restore the parents first order
+	void sort_links();
+
+	SparseComponentContainer<Attachment> links;
+	bool order_dirty = false;
+};
+
+extern TransformHierarchy transform_hierarchy;
@@ -0,0 +1,59 @@
+#include "debug_draw.hpp"
+
+// stlib
+#include <cmath>
+
+DebugDraw debug_draw;
+
+void DebugDraw::line(vec2 from, vec2 to, vec3 color, float width)
+{
+	vec2 direction = to - from;
+	float length = sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length <= 0.f)
+		return;
+
+	// a quad of width around the segment, GL core has no wide lines
+	vec2 side = vec2(-direction.y, direction.x) * (width / 2 / length);
+	triangle_vertices.insert(triangle_vertices.end(), {{from + side, color},
+													   {from - side, color},
+													   {to - side, color},
+													   {from + side, color},
+													   {to - side, color},
+													   {to + side, color}});
+}
+
+void DebugDraw::box(vec2 center, vec2 size, vec3 color, float width)
+{
+	vec2 half = vec2(abs(size.x), abs(size.y)) / 2.f;
+	vec2 top_left = center - half;
+	vec2 bottom_right = center + half;
+	vec2 top_right = {bottom_right.x, top_left.y};
+	vec2 bottom_left = {top_left.x, bottom_right.y};
+	line(top_left, top_right, color, width);
+	line(top_right, bottom_right, color, width);
+	line(bottom_right, bottom_left, color, width);
+	line(bottom_left, top_left, color, width);
+}
+
+void DebugDraw::circle(vec2 center, float radius, vec3 color, float width, int segments)
+{
+	const float step = 2.f * M_PI / segments;
+	vec2 previous = center + vec2(radius, 0.f);
+	for (int i = 1; i <= segments; i++)
+	{
+		vec2 next = center + vec2(cos(i * step), sin(i * step)) * radius;
+		line(previous, next, color, width);
+		previous = next;
+	}
+}
+
+void DebugDraw::text(vec2 position, const std::string &info, float scale, vec3 color)
+{
+	world_texts.push_back({info, position, scale, color});
+}
+
+void DebugDraw::clear()
+{
+	triangle_vertices.clear();
+	world_texts.clear();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "renderer/frame_packet.hpp"
+
+// stlib
+#include <string>
+#include <vector>
+
+// Immediate mode debug shapes, in world space px. Anything drawn during a simulation step
+// stays on screen until the next step starts and calls clear(). Shapes are plain vertices,
+// they never touch the registry, and the renderer draws all of them with a single draw.
+class DebugDraw
+{
+public:
+	static constexpr float LINE_WIDTH = 4.f;
+
+	void line(vec2 from, vec2 to, vec3 color = {1.f, 0.f, 0.f}, float width = LINE_WIDTH);
+	// outline of an axis aligned box
+	void box(vec2 center, vec2 size, vec3 color = {1.f, 0.f, 0.f}, float width = LINE_WIDTH);
+	void circle(vec2 center, float radius, vec3 color = {1.f, 0.f, 0.f}, float width = LINE_WIDTH,
+				int segments = 24);
+	// scale as in Text, the renderer moves it to the screen position of position
+	void text(vec2 position, const std::string &info, float scale = 0.5f, vec3 color = {1.f, 0.f, 0.f});
+
+	void clear();
+
+	// triangles, three vertices each
+	const std::vector<DebugVertex> &vertices() const { return triangle_vertices; }
+	const std::vector<TextDraw> &texts() const { return world_texts; }
+
+private:
+	std::vector<DebugVertex> triangle_vertices;
+	std::vector<TextDraw> world_texts;
+};
+
+// simulation thread, prepare_frame copies it into the frame packet
+extern DebugDraw debug_draw;
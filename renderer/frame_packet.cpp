@@ -0,0 +1,58 @@
+#include "frame_packet.hpp"
+
+void FramePacket::clear()
+{
+	world_sprites.clear();
+	particles.clear();
+	debug_vertices.clear();
+	ui_sprites.clear();
+	texts.clear();
+	menu_text_position = 0;
+}
+
+void FramePacketBuffer::publish(std::chrono::milliseconds timeout)
+{
+	if (ready_state.load(std::memory_order_acquire) & NEW_PACKET)
+	{
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		taken.wait_for(lock, timeout,
+					   [this]() { return (ready_state.load(std::memory_order_acquire) & NEW_PACKET) == 0; });
+	}
+
+	int previous = ready_state.exchange(write_index | NEW_PACKET, std::memory_order_acq_rel);
+	write_index = previous & INDEX_MASK;
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+	}
+	wake.notify_one();
+}
+
+const FramePacket *FramePacketBuffer::acquire(std::chrono::milliseconds timeout)
+{
+	if (!(ready_state.load(std::memory_order_acquire) & NEW_PACKET))
+	{
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		wake.wait_for(lock, timeout, [this]()
+					  { return interrupted || (ready_state.load(std::memory_order_acquire) & NEW_PACKET) != 0; });
+		interrupted = false;
+		if (!(ready_state.load(std::memory_order_acquire) & NEW_PACKET))
+			return nullptr;
+	}
+
+	int previous = ready_state.exchange(read_index, std::memory_order_acq_rel);
+	read_index = previous & INDEX_MASK;
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+	}
+	taken.notify_one();
+	return &packets[read_index];
+}
+
+void FramePacketBuffer::interrupt()
+{
+	{
+		std::lock_guard<std::mutex> lock(wake_mutex);
+		interrupted = true;
+	}
+	wake.notify_all();
+}
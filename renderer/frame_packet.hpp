@@ -0,0 +1,129 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "engine/components.hpp"
+#include "menu/menu_system.hpp"
+
+// stlib
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Everything drawTexturedMesh needs for one sprite, resolved from the registry by the
+// simulation so the render thread never touches it
+struct SpriteDraw
+{
+	mat3 transform;
+	TEXTURE_ASSET_ID texture;
+	EFFECT_ASSET_ID effect;
+	GEOMETRY_BUFFER_ID geometry;
+	vec3 color = {1.f, 1.f, 1.f};
+	float opacity = 1.f;
+	// animated sprites draw the shared SPRITE quad with this part of their sheet: u, v, width,
+	// height of the current frame
+	bool animated = false;
+	vec4 uv_rect = {0.f, 0.f, 1.f, 1.f};
+	// looping clip animated in the vertex shader, uv_rect is its first frame then. 0 for a
+	// fixed frame.
+	int clip_frames = 0;
+	float clip_start = 0.f;
+	float clip_frame_time = 0.f;
+	bool clip_loop = false;
+};
+
+// One particle of the instanced particle draw, laid out as the instance buffer
+struct ParticleInstance
+{
+	vec2 position;
+	vec2 scale;
+	vec3 color;
+};
+
+// One corner of a debug shape triangle, world space
+struct DebugVertex
+{
+	vec2 position;
+	vec3 color;
+};
+
+struct TextDraw
+{
+	std::string text;
+	vec2 position;
+	float scale;
+	vec3 color;
+};
+
+// Immutable snapshot of what to draw for one frame
+struct FramePacket
+{
+	GAME_STATE state = GAME_STATE::MAIN_MENU;
+	// framebuffer size, captured on the main thread by RenderSystem::capture_window_state
+	int width = 0;
+	int height = 0;
+
+	mat3 projection;
+	mat3 view_projection;
+	mat3 ui_projection;
+
+	float darken_screen_factor = 0.f;
+	float time = 0.f;
+	// gameplay ms since start, only advances while in gameplay
+	float sim_time = 0.f;
+	// AnimationSystem::time_ms, the clock shader driven clips are timed against
+	float animation_time = 0.f;
+
+	// gameplay: world sprites, then particles, then debug shapes, then UI sprites, then texts
+	// menus: ui_sprites with the texts drawn in before ui_sprites[menu_text_position]
+	std::vector<SpriteDraw> world_sprites;
+	std::vector<ParticleInstance> particles;
+	std::vector<DebugVertex> debug_vertices;
+	std::vector<SpriteDraw> ui_sprites;
+	std::vector<TextDraw> texts;
+	size_t menu_text_position = 0;
+
+	// keeps the capacity, packets are reused every frame
+	void clear();
+};
+
+// Triple buffer of frame packets between the simulation and the render thread. The
+// simulation always has a packet to write into and the render thread always has the
+// newest finished one. The render thread is paced by the buffer swap, the simulation by
+// publish, which waits for the render thread to take the previous packet.
+class FramePacketBuffer
+{
+public:
+	// Simulation side: the packet to fill for the next frame
+	FramePacket &write_packet() { return packets[write_index]; }
+
+	// Simulation side: hand the filled packet over. Waits up to timeout for the render thread
+	// to take the previous one, after that the previous one is replaced without being drawn.
+	void publish(std::chrono::milliseconds timeout);
+
+	// Render side: the newest published packet, or nullptr if nothing new arrived within
+	// timeout. The packet stays valid until the next acquire.
+	const FramePacket *acquire(std::chrono::milliseconds timeout);
+
+	// Wake up a render thread blocked in acquire
+	void interrupt();
+
+private:
+	static constexpr int INDEX_MASK = 0x3;
+	static constexpr int NEW_PACKET = 0x4;
+
+	FramePacket packets[3];
+	int write_index = 0;
+	int read_index = 1;
+	// index of the packet in the middle, plus NEW_PACKET when it has not been read yet
+	std::atomic<int> ready_state{2};
+
+	std::mutex wake_mutex;
+	std::condition_variable wake;
+	// the render thread took the published packet
+	std::condition_variable taken;
+	bool interrupted = false;
+};
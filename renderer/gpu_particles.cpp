@@ -0,0 +1,220 @@
+#include "gpu_particles.hpp"
+#include "renderer/render_system.hpp"
+#include "engine/logger.hpp"
+
+// stlib
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+
+GpuParticleSystem gpu_particles;
+
+namespace {
+	// interleaved state, the same layout as GpuParticleSpawn
+	const std::vector<const char *> state_varyings = {"out_position", "out_velocity", "out_scale", "out_color",
+													  "out_ttl"};
+
+	struct StateAttribute
+	{
+		const char *name;
+		GLint size;
+		size_t offset;
+	};
+
+	const StateAttribute state_attributes[] = {
+		{"in_position", 2, offsetof(GpuParticleSpawn, position)},
+		{"in_velocity", 2, offsetof(GpuParticleSpawn, velocity)},
+		{"in_scale", 2, offsetof(GpuParticleSpawn, scale)},
+		{"in_color", 3, offsetof(GpuParticleSpawn, color)},
+		{"in_ttl", 1, offsetof(GpuParticleSpawn, ttl)},
+	};
+
+	// bind the state attributes the program uses, with divisor 1 for the instanced draw
+	void bindStateAttributes(GLuint program, GLuint divisor)
+	{
+		for (const StateAttribute &attribute : state_attributes)
+		{
+			GLint loc = glGetAttribLocation(program, attribute.name);
+			if (loc < 0)
+				continue;
+			glEnableVertexAttribArray(loc);
+			glVertexAttribPointer(loc, attribute.size, GL_FLOAT, GL_FALSE, sizeof(GpuParticleSpawn),
+								  (void *)attribute.offset);
+			glVertexAttribDivisor(loc, divisor);
+		}
+		gl_has_errors();
+	}
+}
+
+size_t GpuParticleSystem::emit(const std::vector<GpuParticleSpawn> &spawns)
+{
+	std::lock_guard<std::mutex> lock(spawn_mutex);
+	size_t room = MAX_SPAWNS_PER_FRAME - std::min(pending.size(), MAX_SPAWNS_PER_FRAME);
+	size_t accepted = std::min(room, spawns.size());
+	pending.insert(pending.end(), spawns.begin(), spawns.begin() + accepted);
+
+	emitted.fetch_add(accepted, std::memory_order_relaxed);
+	dropped.fetch_add(spawns.size() - accepted, std::memory_order_relaxed);
+	return accepted;
+}
+
+void GpuParticleSystem::clear()
+{
+	std::lock_guard<std::mutex> lock(spawn_mutex);
+	pending.clear();
+	clear_requested = true;
+}
+
+bool GpuParticleSystem::init(GLuint quad_vbo, GLuint quad_ibo, GLsizei quad_index_count)
+{
+	const char *setting = std::getenv("GUNCAT_GPU_PARTICLES");
+	if (setting && std::atoi(setting) == 0)
+	{
+		LOG_INFO(LOG_CATEGORY::PARTICLE, "GPU particles turned off");
+		return false;
+	}
+
+	if (!loadTransformFeedbackEffect(shader_path("particle_update") + ".vs.glsl", state_varyings, update_program) ||
+		!loadEffectFromFile(shader_path("gpu_particle") + ".vs.glsl", shader_path("particle") + ".fs.glsl",
+							draw_program))
+	{
+		LOG_WARN(LOG_CATEGORY::PARTICLE, "GPU particle shaders failed, all particles stay on the CPU");
+		return false;
+	}
+
+	quad_indices = quad_index_count;
+	uploading.reserve(MAX_SPAWNS_PER_FRAME);
+	pending.reserve(MAX_SPAWNS_PER_FRAME);
+
+	// no contents, a slot is only read once a spawn wrote it
+	glGenBuffers(2, state_buffers);
+	glGenVertexArrays(2, update_vaos);
+	glGenVertexArrays(2, draw_vaos);
+	for (int i = 0; i < 2; i++)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, state_buffers[i]);
+		glBufferData(GL_ARRAY_BUFFER, CAPACITY * sizeof(GpuParticleSpawn), nullptr, GL_DYNAMIC_COPY);
+
+		glBindVertexArray(update_vaos[i]);
+		bindStateAttributes(update_program, 0);
+
+		glBindVertexArray(draw_vaos[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quad_ibo);
+		GLint in_corner_loc = glGetAttribLocation(draw_program, "in_corner");
+		assert(in_corner_loc >= 0);
+		glEnableVertexAttribArray(in_corner_loc);
+		glVertexAttribPointer(in_corner_loc, 3, GL_FLOAT, GL_FALSE, sizeof(ColoredVertex), (void *)0);
+		glBindBuffer(GL_ARRAY_BUFFER, state_buffers[i]);
+		bindStateAttributes(draw_program, 1);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	gl_has_errors();
+
+	enabled.store(true);
+	LOG_INFO(LOG_CATEGORY::PARTICLE, "GPU particles ready, %zu slots", CAPACITY);
+	return true;
+}
+
+void GpuParticleSystem::upload_spawns(float sim_time_ms)
+{
+	bool clear_state;
+	{
+		std::lock_guard<std::mutex> lock(spawn_mutex);
+		uploading.swap(pending);
+		clear_state = clear_requested;
+		clear_requested = false;
+	}
+
+	// nothing past used_slots is read, a clear only has to start over at slot 0
+	if (clear_state)
+	{
+		ring_cursor = 0;
+		used_slots = 0;
+		alive_until = 0.f;
+	}
+
+	// the next update reads state_buffers[current], spawns go there
+	glBindBuffer(GL_ARRAY_BUFFER, state_buffers[current]);
+
+	// round robin, wrapping around at the end
+	size_t written = 0;
+	while (written < uploading.size())
+	{
+		size_t count = std::min(uploading.size() - written, CAPACITY - ring_cursor);
+		glBufferSubData(GL_ARRAY_BUFFER, ring_cursor * sizeof(GpuParticleSpawn), count * sizeof(GpuParticleSpawn),
+						uploading.data() + written);
+		written += count;
+		// before the ring wraps the cursor is at used_slots, new slots are always written
+		used_slots = std::max(used_slots, ring_cursor + count);
+		ring_cursor = (ring_cursor + count) % CAPACITY;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	gl_has_errors();
+
+	for (const GpuParticleSpawn &spawn : uploading)
+		alive_until = std::max(alive_until, sim_time_ms + spawn.ttl);
+	uploading.clear();
+}
+
+void GpuParticleSystem::update(float sim_time_ms, float gravity)
+{
+	if (!is_enabled())
+		return;
+
+	// packets the render thread never saw are skipped, so step by the sim time difference
+	// instead of a frame time
+	float dt_ms = last_sim_time < 0.f ? 0.f : std::max(0.f, sim_time_ms - last_sim_time);
+	last_sim_time = sim_time_ms;
+
+	upload_spawns(sim_time_ms);
+	// everything expired, the state stays as it is until the next spawn
+	if (used_slots == 0 || sim_time_ms - dt_ms >= alive_until)
+		return;
+
+	glUseProgram(update_program);
+	glUniform1f(glGetUniformLocation(update_program, "dt"), dt_ms / 1000.f);
+	glUniform1f(glGetUniformLocation(update_program, "gravity"), gravity);
+
+	glBindVertexArray(update_vaos[current]);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, state_buffers[1 - current]);
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, (GLsizei)used_slots);
+	glEndTransformFeedback();
+	glDisable(GL_RASTERIZER_DISCARD);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glBindVertexArray(0);
+	gl_has_errors();
+
+	current = 1 - current;
+}
+
+void GpuParticleSystem::draw(const mat3 &projection)
+{
+	if (!is_enabled() || used_slots == 0 || last_sim_time >= alive_until)
+		return;
+
+	glUseProgram(draw_program);
+	GLint projection_loc = glGetUniformLocation(draw_program, "projection");
+	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
+
+	// dead slots collapse to a point outside the screen in the vertex shader
+	glBindVertexArray(draw_vaos[current]);
+	glDrawElementsInstanced(GL_TRIANGLES, quad_indices, GL_UNSIGNED_SHORT, nullptr, (GLsizei)used_slots);
+	glBindVertexArray(0);
+	gl_has_errors();
+}
+
+void GpuParticleSystem::destroy()
+{
+	if (!is_enabled())
+		return;
+	enabled.store(false);
+	glDeleteVertexArrays(2, draw_vaos);
+	glDeleteVertexArrays(2, update_vaos);
+	glDeleteBuffers(2, state_buffers);
+	glDeleteProgram(draw_program);
+	glDeleteProgram(update_program);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// One particle as stored in the GPU state buffers and in the spawn queue
+struct GpuParticleSpawn
+{
+	vec2 position;
+	vec2 velocity;
+	vec2 scale;
+	vec3 color;
+	float ttl; // ms
+};
+
+// Particle state lives in two GL buffers that are updated with transform feedback and
+// swapped every frame, the CPU only ever writes newly spawned particles into them. Slots
+// are handed out round robin, so past CAPACITY live particles the oldest ones get reused.
+// Until the ring wraps, only the slots handed out so far are stepped and drawn.
+// Everything is GL 3.3 core.
+class GpuParticleSystem
+{
+public:
+	static constexpr size_t CAPACITY = 65536;
+	static constexpr size_t MAX_SPAWNS_PER_FRAME = 8192;
+
+	// Any thread: queue particles for the next update, returns how many were accepted
+	size_t emit(const std::vector<GpuParticleSpawn> &spawns);
+	// Any thread: kill every particle at the next update
+	void clear();
+	// false until init succeeded or when turned off with GUNCAT_GPU_PARTICLES=0
+	bool is_enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	// GL thread
+	bool init(GLuint quad_vbo, GLuint quad_ibo, GLsizei quad_index_count);
+	// Upload the queued spawns and step every particle to sim_time_ms
+	void update(float sim_time_ms, float gravity);
+	void draw(const mat3 &projection);
+	void destroy();
+
+	// metrics
+	std::atomic<uint64_t> emitted{0};
+	std::atomic<uint64_t> dropped{0};
+
+private:
+	void upload_spawns(float sim_time_ms);
+
+	std::atomic<bool> enabled{false};
+
+	std::mutex spawn_mutex;
+	std::vector<GpuParticleSpawn> pending;
+	bool clear_requested = false;
+	// GL thread only from here on
+	std::vector<GpuParticleSpawn> uploading;
+
+	GLuint update_program = 0;
+	GLuint draw_program = 0;
+	GLuint state_buffers[2] = {0, 0};
+	GLuint update_vaos[2] = {0, 0};
+	GLuint draw_vaos[2] = {0, 0};
+	GLsizei quad_indices = 0;
+	int current = 0;
+
+	size_t ring_cursor = 0;
+	// slots written since the last clear, update and draw only cover [0, used_slots). Slots
+	// past it hold whatever was there before the clear and are never read.
+	size_t used_slots = 0;
+	float last_sim_time = -1.f;
+	// sim time at which the last particle expires, nothing to do past it
+	float alive_until = 0.f;
+};
+
+extern GpuParticleSystem gpu_particles;
@@ -1,22 +1,117 @@
 #include "common.hpp"
 
 #include "particle_system.hpp"
+#include "renderer/gpu_particles.hpp"
+#include "engine/logger.hpp"
+#include "engine/swap_remove.hpp"
 
+// stlib
+#include <algorithm>
 
-std::vector<Entity> ParticleSystem::spawnParticles(vec2 position, vec2 velocity, vec2 scale, float ttl, vec3 color,
-												   int num, float angle_range)
+
+ParticlePool particle_pool;
+
+ParticlePool::ParticlePool()
+{
+	// everything is allocated up front, spawning never allocates
+	bodies.position_x.reserve(CAPACITY);
+	bodies.position_y.reserve(CAPACITY);
+	bodies.velocity_x.reserve(CAPACITY);
+	bodies.velocity_y.reserve(CAPACITY);
+	bodies.gravity_scale.reserve(CAPACITY);
+	bodies.friction.reserve(CAPACITY);
+	ttl.reserve(CAPACITY);
+	color_r.reserve(CAPACITY);
+	color_g.reserve(CAPACITY);
+	color_b.reserve(CAPACITY);
+	scale_x.reserve(CAPACITY);
+	scale_y.reserve(CAPACITY);
+}
+
+bool ParticlePool::add(vec2 position, vec2 velocity, vec2 scale, float ttl_ms, vec3 color)
+{
+	if (full())
+	{
+		dropped++;
+		return false;
+	}
+
+	bodies.position_x.push_back(position.x);
+	bodies.position_y.push_back(position.y);
+	bodies.velocity_x.push_back(velocity.x);
+	bodies.velocity_y.push_back(velocity.y);
+	bodies.gravity_scale.push_back(1.f);
+	bodies.friction.push_back(0.f);
+	ttl.push_back(ttl_ms);
+	color_r.push_back(color.x);
+	color_g.push_back(color.y);
+	color_b.push_back(color.z);
+	scale_x.push_back(scale.x);
+	scale_y.push_back(scale.y);
+
+	spawned++;
+	peak = std::max(peak, size());
+	return true;
+}
+
+template <typename T>
+static void swap_remove(std::vector<T> &values, size_t i)
+{
+	values[i] = values.back();
+	values.pop_back();
+}
+
+void ParticlePool::remove(size_t i)
+{
+	swap_remove(bodies.position_x, i);
+	swap_remove(bodies.position_y, i);
+	swap_remove(bodies.velocity_x, i);
+	swap_remove(bodies.velocity_y, i);
+	swap_remove(bodies.gravity_scale, i);
+	swap_remove(bodies.friction, i);
+	swap_remove(ttl, i);
+	swap_remove(color_r, i);
+	swap_remove(color_g, i);
+	swap_remove(color_b, i);
+	swap_remove(scale_x, i);
+	swap_remove(scale_y, i);
+}
+
+void ParticlePool::clear()
+{
+	// keeps the capacity
+	bodies.clear();
+	ttl.clear();
+	color_r.clear();
+	color_g.clear();
+	color_b.clear();
+	scale_x.clear();
+	scale_y.clear();
+}
+
+int ParticleSystem::spawnParticles(vec2 position, vec2 velocity, vec2 scale, float ttl, vec3 color, int num,
+								   float angle_range)
 {
-	// Create a random number generator
-	std::random_device rd; // Seed for randomness
-	std::mt19937 gen(rd()); // Mersenne Twister generator
+	// seeded once, a random_device per burst is slow on some platforms
+	static std::mt19937 gen(std::random_device{}()); // Mersenne Twister generator
 	std::uniform_real_distribution<float> angle_dist(-angle_range,
 													 angle_range); // Random angle in [-angle_range, angle_range]
 	std::uniform_real_distribution<float> scale_dist(0.0f, 1.0f); // Random scale in [0, 1]
 
-	std::vector<Entity> particles;
+	bool on_gpu = num >= GPU_BURST_MIN && gpu_particles.is_enabled();
+	static std::vector<GpuParticleSpawn> gpu_spawns;
+	gpu_spawns.clear();
 
+	int spawned = 0;
 	for (int i = 0; i < num; ++i) // Use <, not <= to match `num` particles
 	{
+		// no point rolling random numbers for particles that get dropped
+		if (!on_gpu && particle_pool.full())
+		{
+			particle_pool.dropped += num - i;
+			break;
+		}
+
 		// Generate a random angle
 		float angle_deg = angle_dist(gen);
 		float angle_rad = angle_deg * (M_PI / 180.0f); // Convert degrees to radians
@@ -29,10 +124,15 @@ std::vector<Entity> ParticleSystem::spawnParticles(vec2 position, vec2 velocity,
 		new_velocity *= random_scale;
 
 		// Create the particle with the new velocity
-		Entity particle = ParticleSystem::createParticle(position, new_velocity, scale, ttl, color);
-		particles.push_back(particle);
+		if (on_gpu)
+			gpu_spawns.push_back({position, new_velocity, scale, color, ttl});
+		else if (ParticleSystem::createParticle(position, new_velocity, scale, ttl, color))
+			spawned++;
 	}
-	return particles;
+
+	if (on_gpu)
+		spawned = (int)gpu_particles.emit(gpu_spawns);
+	return spawned;
 }
 
 
@@ -59,45 +159,44 @@ std::vector<Entity> ParticleSystem::spawnParticles(vec2 position, vec2 velocity,
 //	return particles;
 //}
 
-Entity ParticleSystem::createParticle(vec2 position, vec2 velocity, vec2 scale, float ttl, vec3 color) 
+bool ParticleSystem::createParticle(vec2 position, vec2 velocity, vec2 scale, float ttl, vec3 color) 
 {
-	Entity entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object (the value is stored in the resource cache)
-	registry.renderRequests.insert(
-		entity, {TEXTURE_ASSET_ID::TEXTURE_COUNT, EFFECT_ASSET_ID::EGG, GEOMETRY_BUFFER_ID::PARTICLE});
+	return particle_pool.add(position, velocity, scale, ttl, color);
+}
 
-	// Create motion
-	Motion &motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.velocity = velocity;
-	motion.position = position;
-	motion.scale = scale;
+void ParticleSystem::step(float elapsed_ms)
+{
+	ParticlePool &pool = particle_pool;
 
-	// Create particle
-	Particle &particle = registry.particles.emplace(entity, Particle{ttl});
+	// same integration as everything else with gravity
+	integrate_motions(pool.bodies, {elapsed_ms / 1000.f, PARTICLE_GRAVITY});
 
-	// Set color
-	registry.colors.insert(entity, color);
+	float *ttl = pool.ttl.data();
+	for (size_t i = 0; i < pool.size(); i++)
+		ttl[i] -= elapsed_ms;
 
-	// Put it in the gravity system
-	registry.gravities.emplace(entity);
+	//clear particles after ttl expires
+	swap_remove_if(
+		pool.size(), [&pool](size_t i) { return pool.ttl[i] <= 0; }, [&pool](size_t i) { pool.remove(i); });
 
-	return entity;
+	if (pool.dropped != reported_dropped)
+	{
+		LOG_WARN(LOG_CATEGORY::PARTICLE, "pool full (%zu), dropped %llu particles, %llu total", ParticlePool::CAPACITY,
+				 (unsigned long long)(pool.dropped - reported_dropped), (unsigned long long)pool.dropped);
+		reported_dropped = pool.dropped;
+	}
 }
 
-void ParticleSystem::step(float elapsed_ms)
+void ParticleSystem::collectInstances(std::vector<ParticleInstance> &out)
 {
-	//clear particles after ttl expires
-	for (Entity entity : registry.particles.entities)
+	const ParticlePool &pool = particle_pool;
+	size_t count = pool.size();
+	out.resize(count);
+	for (size_t i = 0; i < count; i++)
 	{
-		Particle &particle = registry.particles.get(entity);
-		particle.counter_ttl -= elapsed_ms;
-		if (particle.counter_ttl <= 0)
-		{
-			std::cout << particle.counter_ttl << std::endl;
-			registry.remove_all_components_of(entity);
-		}
+		ParticleInstance &instance = out[i];
+		instance.position = {pool.bodies.position_x[i], pool.bodies.position_y[i]};
+		instance.scale = {pool.scale_x[i], pool.scale_y[i]};
+		instance.color = {pool.color_r[i], pool.color_g[i], pool.color_b[i]};
 	}
 }
-
@@ -2,22 +2,68 @@
 
 // internal
 #include "common.hpp"
-#include "engine/tiny_ecs.hpp"
-#include "engine/components.hpp"
-#include "engine/tiny_ecs_registry.hpp"
-#include "renderer/render_system.hpp"
+#include "engine/motion_soa.hpp"
+#include "renderer/frame_packet.hpp"
 
 
 // stlib
+#include <cstdint>
 #include <vector>
 #include <random>
 
+// Particles live outside the ECS in one fixed capacity pool with an array per field. Spawns
+// beyond the capacity are dropped and counted instead of growing the pool.
+struct ParticlePool
+{
+	static constexpr size_t CAPACITY = 4096;
+
+	// position, velocity and gravity, integrated with integrate_motions
+	MotionSoA bodies;
+	std::vector<float> ttl; // ms left
+	std::vector<float> color_r;
+	std::vector<float> color_g;
+	std::vector<float> color_b;
+	std::vector<float> scale_x;
+	std::vector<float> scale_y;
+
+	// metrics, never reset
+	uint64_t spawned = 0;
+	uint64_t dropped = 0;
+	size_t peak = 0;
+
+	ParticlePool();
+
+	size_t size() const { return ttl.size(); }
+	bool full() const { return size() >= CAPACITY; }
+
+	// false (and counted as dropped) when the pool is full
+	bool add(vec2 position, vec2 velocity, vec2 scale, float ttl_ms, vec3 color);
+	// swaps the last particle into slot i
+	void remove(size_t i);
+	void clear();
+};
+
+extern ParticlePool particle_pool;
+
+// downward acceleration of particles, px/s^2
+constexpr float PARTICLE_GRAVITY = 800.f;
+
 class ParticleSystem
 {
 public:
 	ParticleSystem() = default;
-	static std::vector<Entity> spawnParticles(vec2 position, vec2 velocity, vec2 scale, float ttl, vec3 color, int num,
-											  float angle_range = 60.0f);
-	static Entity createParticle(vec2 position, vec2 velocity, vec2 scale, float ttl, vec3 color);
+	// Bursts of at least GPU_BURST_MIN particles (boss deaths, explosions) go to the GPU
+	// particles when those are available, smaller ones to the pool.
+	// Returns how many particles were accepted.
+	static constexpr int GPU_BURST_MIN = 64;
+	static int spawnParticles(vec2 position, vec2 velocity, vec2 scale, float ttl, vec3 color, int num,
+							  float angle_range = 60.0f);
+	static bool createParticle(vec2 position, vec2 velocity, vec2 scale, float ttl, vec3 color);
 	void step(float elapsed_ms);
+
+	// per instance data for the single instanced particle draw
+	static void collectInstances(std::vector<ParticleInstance> &out);
+
+private:
+	uint64_t reported_dropped = 0;
 };
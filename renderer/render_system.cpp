@@ -8,6 +8,12 @@
 #include <glm/gtc/type_ptr.hpp>
 #include "animation/animation_system.hpp"
 #include "engine/tiny_ecs_registry.hpp"
+#include "engine/ecs_view.hpp"
+#include "renderer/particle_system.hpp"
+#include "renderer/gpu_particles.hpp"
+#include "renderer/world_transforms.hpp"
+#include "renderer/debug_draw.hpp"
+#include "engine/logger.hpp"
 #include "weapons/weapon_system.hpp"
 #include <glm/gtc/type_ptr.hpp>
 #include "world/world_init.hpp"
@@ -16,36 +22,176 @@
 #include <fstream>     // For file reading
 #include <sstream>     // For parsing file contents
 #include <iomanip>
+#include <algorithm>
+#include <cstddef>
 
 #include "loader/LoaderSystem.hpp"
 
-// Note: drawTexturedMesh now takes a current frame, frame width, and elapsed time for animation purposes
-void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, int &frameCurrent, GLfloat &frameWidth, float elapsed_ms)
+// Swap in the hovered/selected texture of a button
+TEXTURE_ASSET_ID RenderSystem::resolveButtonTexture(Entity entity, TEXTURE_ASSET_ID texture)
 {
-	Motion &motion = registry.motions.get(entity);
-	// Transformation code, see Rendering and Transformation in the template
-	// specification for more info Incrementally updates transformation matrix,
-	// thus ORDER IS IMPORTANT
-	Transform transform;
-	transform.translate(motion.position);
-	// Weapon will definitely rotate, don't know about the cat.
-	transform.rotate(motion.angle);
-	transform.scale(motion.scale);
+	TEXTURE_ASSET_ID resolved = texture;
+	if (registry.buttons.has(entity))
+	{
+		Button &button = registry.buttons.get(entity);
+		if (button.hovered)
+		{
+			switch (texture)
+			{
+			case TEXTURE_ASSET_ID::START_BUTTON:
+				resolved = TEXTURE_ASSET_ID::START_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::MENU_BUTTON:
+				resolved = TEXTURE_ASSET_ID::MENU_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::OPTIONS_BUTTON:
+				resolved = TEXTURE_ASSET_ID::OPTIONS_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::RESUME_BUTTON:
+				resolved = TEXTURE_ASSET_ID::RESUME_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::BACK_BUTTON:
+				resolved = TEXTURE_ASSET_ID::BACK_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::QUIT_BUTTON:
+				resolved = TEXTURE_ASSET_ID::QUIT_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::RESTART_BUTTON:
+				resolved = TEXTURE_ASSET_ID::RESTART_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::LVL_1_BUTTON:
+				resolved = TEXTURE_ASSET_ID::LVL_1_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::LVL_2_BUTTON:
+				if(loader.get_level_save_data() >= 1)
+				{
+					resolved = TEXTURE_ASSET_ID::LVL_2_BUTTON_CLICKED;
+				}
+				else
+				{
+					resolved = TEXTURE_ASSET_ID::LVL_2_BUTTON_CLICKED_LOCKED;
+				}
+				break;
+			case TEXTURE_ASSET_ID::LVL_3_BUTTON:
+				if(loader.get_level_save_data() >= 2)
+				{
+					resolved = TEXTURE_ASSET_ID::LVL_3_BUTTON_CLICKED;
+				}
+				else
+				{
+					resolved = TEXTURE_ASSET_ID::LVL_3_BUTTON_CLICKED_LOCKED;
+				}
+				break;
+			case TEXTURE_ASSET_ID::OUTFIT_BUTTON:
+				resolved = TEXTURE_ASSET_ID::OUTFIT_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::LORE_BUTTON:
+				resolved = TEXTURE_ASSET_ID::LORE_BUTTON_CLICKED;
+				break;
+			case TEXTURE_ASSET_ID::NOTE_1_ICON:
+				resolved = TEXTURE_ASSET_ID::NOTE_1_ICON_SELECTED;
+				break;
+			case TEXTURE_ASSET_ID::NOTE_2_ICON:
+				resolved = TEXTURE_ASSET_ID::NOTE_2_ICON_SELECTED;
+				break;
+			case TEXTURE_ASSET_ID::NOTE_3_ICON:
+				resolved = TEXTURE_ASSET_ID::NOTE_3_ICON_SELECTED;
+				break;
+			case TEXTURE_ASSET_ID::CLOSE:
+				resolved = TEXTURE_ASSET_ID::CLOSE_SELECTED;
+				break;
+			default:
+				break;
+			}
+		}
+		if (button.selected)
+		{
+			switch (texture)
+			{
+			case TEXTURE_ASSET_ID::CAT_SKIN:
+				resolved = TEXTURE_ASSET_ID::CAT_SKIN_SELECTED;
+				break;
+			case TEXTURE_ASSET_ID::CAT_SKIN_XMAS:
+				resolved = TEXTURE_ASSET_ID::CAT_SKIN_XMAS_SELECTED;
+				break;
+			case TEXTURE_ASSET_ID::CAT_SKIN_SLIME:
+				resolved = TEXTURE_ASSET_ID::CAT_SKIN_SLIME_SELECTED;
+				break;
+			case TEXTURE_ASSET_ID::CAT_SKIN_SCH:
+				resolved = TEXTURE_ASSET_ID::CAT_SKIN_SCH_SELECTED;
+				break;
+			case TEXTURE_ASSET_ID::CAT_SKIN_RAINBOW:
+				resolved = TEXTURE_ASSET_ID::CAT_SKIN_RAINBOW_SELECTED;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	return resolved;
+}
 
+// Resolve everything drawTexturedMesh needs from the registry
+SpriteDraw RenderSystem::makeSpriteDraw(Entity entity, const mat3 &transform)
+{
 	assert(registry.renderRequests.has(entity));
 	const RenderRequest &render_request = registry.renderRequests.get(entity);
 
-	const GLuint used_effect_enum = (GLuint)render_request.used_effect;
+	SpriteDraw sprite;
+	sprite.transform = transform;
+	sprite.texture = render_request.used_texture;
+	sprite.effect = render_request.used_effect;
+	sprite.geometry = render_request.used_geometry;
+	if (registry.buttons.has(entity))
+		sprite.texture = resolveButtonTexture(entity, render_request.used_texture);
+	sprite.color = registry.colors.has(entity) ? registry.colors.get(entity) : vec3(1);
+	sprite.opacity = registry.opacities.has(entity) ? registry.opacities.get(entity) : 1.f;
+
+	// animation geometries only describe the sheet, the frame resolved by the last animation
+	// step picks the rect on it
+	int frames = animationGeometryFrames(render_request.used_geometry);
+	if (frames > 0)
+	{
+		int frame_current = 0;
+		if (animation_frames.has(entity))
+		{
+			const AnimationFrame &frame = animation_frames.get(entity);
+			sprite.clip_frames = frame.clip_frames;
+			sprite.clip_start = frame.clip_start;
+			sprite.clip_frame_time = frame.clip_frame_time;
+			sprite.clip_loop = frame.clip_loop;
+			if (frame.clip_frames == 0)
+				frame_current = std::min(frame.frame_current, frames - 1);
+		}
+		float frame_width = 1.f / frames;
+		sprite.animated = true;
+		sprite.uv_rect = vec4(frame_current * frame_width, 0.f, frame_width, 1.f);
+	}
+	return sprite;
+}
+
+// Draws one sprite of a frame packet, only touches GL state
+void RenderSystem::drawTexturedMesh(const SpriteDraw &sprite, const mat3 &projection)
+{
+	const GLuint used_effect_enum = (GLuint)sprite.effect;
 	assert(used_effect_enum != (GLuint)EFFECT_ASSET_ID::EFFECT_COUNT);
-	const GLuint program = (GLuint)effects[used_effect_enum];
+	// every animation shares the SPRITE quad and only differs in the part of the sheet it shows,
+	// player sheets differ in the layer of their skin sheet array
+	const bool animated = sprite.effect == EFFECT_ASSET_ID::TEXTURED && sprite.animated;
+	const SkinSheetLayer sheet = animated ? skinSheetLayer(sprite.texture) : SkinSheetLayer{};
+	const bool layered = sheet.layer >= 0 && skin_sheet_arrays[(GLuint)sheet.geometry] != 0;
+	GLuint program = (GLuint)effects[used_effect_enum];
+	if (animated)
+		program = layered ? m_skin_sprite_program : m_animated_sprite_program;
+	const GEOMETRY_BUFFER_ID geometry = animated ? GEOMETRY_BUFFER_ID::SPRITE : sprite.geometry;
 
 	// Setting shaders
 	glUseProgram(program);
 	gl_has_errors();
 
-	assert(render_request.used_geometry != GEOMETRY_BUFFER_ID::GEOMETRY_COUNT);
-	const GLuint vbo = vertex_buffers[(GLuint)render_request.used_geometry];
-	const GLuint ibo = index_buffers[(GLuint)render_request.used_geometry];
+	assert(geometry != GEOMETRY_BUFFER_ID::GEOMETRY_COUNT);
+	const GLuint vbo = vertex_buffers[(GLuint)geometry];
+	const GLuint ibo = index_buffers[(GLuint)geometry];
 
 	// setting VAO
 	glBindVertexArray(vao);
@@ -55,7 +201,7 @@ void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, int &
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
 	gl_has_errors();
 
-	if (render_request.used_effect == EFFECT_ASSET_ID::EGG)
+	if (sprite.effect == EFFECT_ASSET_ID::EGG)
 	{
 		GLint in_position_loc = glGetAttribLocation(program, "in_position");
 		GLint in_color_loc = glGetAttribLocation(program, "in_color");
@@ -68,7 +214,7 @@ void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, int &
 		glEnableVertexAttribArray(in_color_loc);
 		glVertexAttribPointer(in_color_loc, 3, GL_FLOAT, GL_FALSE, sizeof(ColoredVertex), (void *)sizeof(vec3));
 		gl_has_errors();
-	}else if (render_request.used_effect == EFFECT_ASSET_ID::TEXTURED)
+	}else if (sprite.effect == EFFECT_ASSET_ID::TEXTURED)
 	{
 		GLint in_position_loc = glGetAttribLocation(program, "in_position");
 		GLint in_texcoord_loc = glGetAttribLocation(program, "in_texcoord");
@@ -90,116 +236,39 @@ void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, int &
 		glActiveTexture(GL_TEXTURE0);
 		gl_has_errors();
 
-		assert(registry.renderRequests.has(entity));
-		GLuint texture_id =
-			texture_gl_handles[(GLuint)registry.renderRequests.get(entity).used_texture];
-
-		// Check hover state
-		if (registry.buttons.has(entity))
+		vec4 uv_rect = sprite.uv_rect;
+		if (layered)
 		{
-			Button &button = registry.buttons.get(entity);
-			if (button.hovered)
-			{
-				switch (registry.renderRequests.get(entity).used_texture)
-				{
-				case TEXTURE_ASSET_ID::START_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::START_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::MENU_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::MENU_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::OPTIONS_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::OPTIONS_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::RESUME_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::RESUME_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::BACK_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::BACK_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::QUIT_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::QUIT_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::RESTART_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::RESTART_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::LVL_1_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::LVL_1_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::LVL_2_BUTTON:
-					if(loader.get_level_save_data() >= 1)
-					{
-						texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::LVL_2_BUTTON_CLICKED];
-					}
-					else
-					{
-						texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::LVL_2_BUTTON_CLICKED_LOCKED];
-					}
-					break;
-				case TEXTURE_ASSET_ID::LVL_3_BUTTON:
-					if(loader.get_level_save_data() >= 2)
-					{
-						texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::LVL_3_BUTTON_CLICKED];
-					}
-					else
-					{
-						texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::LVL_3_BUTTON_CLICKED_LOCKED];
-					}
-					break;
-				case TEXTURE_ASSET_ID::OUTFIT_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::OUTFIT_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::LORE_BUTTON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::LORE_BUTTON_CLICKED];
-					break;
-				case TEXTURE_ASSET_ID::NOTE_1_ICON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::NOTE_1_ICON_SELECTED];
-					break;
-				case TEXTURE_ASSET_ID::NOTE_2_ICON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::NOTE_2_ICON_SELECTED];
-					break;
-				case TEXTURE_ASSET_ID::NOTE_3_ICON:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::NOTE_3_ICON_SELECTED];
-					break;
-				case TEXTURE_ASSET_ID::CLOSE:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::CLOSE_SELECTED];
-					break;
-				default:
-					break;
-				}
-			}
-			if (button.selected)
-			{
-				switch (registry.renderRequests.get(entity).used_texture)
-				{
-				case TEXTURE_ASSET_ID::CAT_SKIN:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::CAT_SKIN_SELECTED];
-					break;
-				case TEXTURE_ASSET_ID::CAT_SKIN_XMAS:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::CAT_SKIN_XMAS_SELECTED];
-					break;
-				case TEXTURE_ASSET_ID::CAT_SKIN_SLIME:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::CAT_SKIN_SLIME_SELECTED];
-					break;
-				case TEXTURE_ASSET_ID::CAT_SKIN_SCH:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::CAT_SKIN_SCH_SELECTED];
-					break;
-				case TEXTURE_ASSET_ID::CAT_SKIN_RAINBOW:
-					texture_id = texture_gl_handles[(GLuint)TEXTURE_ASSET_ID::CAT_SKIN_RAINBOW_SELECTED];
-					break;
-				default:
-					break;
-				}
-			}
+			// skin switches only change the layer, the array stays the same
+			glBindTexture(GL_TEXTURE_2D_ARRAY, skin_sheet_arrays[(GLuint)sheet.geometry]);
+			glUniform1f(glGetUniformLocation(program, "layer"), (float)sheet.layer);
+			const vec2 &scale = skin_sheet_scales[(GLuint)sprite.texture];
+			uv_rect *= vec4(scale, scale);
+		}
+		else
+		{
+			GLuint texture_id = texture_gl_handles[(GLuint)sprite.texture];
+			glBindTexture(GL_TEXTURE_2D, texture_id);
 		}
-		glBindTexture(GL_TEXTURE_2D, texture_id);
 		gl_has_errors();
 
 		///////////////////////ANIMATION//////////////////////////
-		GLint frame_uloc = glGetUniformLocation(program, "atFrame");
-		GLfloat frame_width_uloc = glGetUniformLocation(program, "frameWidth");
-		glUniform1i(frame_uloc, frameCurrent);
-		glUniform1f(frame_width_uloc, frameWidth);
+		if (animated)
+		{
+			glUniform4fv(glGetUniformLocation(program, "uvRect"), 1, (float *)&uv_rect);
+			glUniform1f(glGetUniformLocation(program, "clipStart"), sprite.clip_start);
+			glUniform1i(glGetUniformLocation(program, "clipFrames"), sprite.clip_frames);
+			glUniform1f(glGetUniformLocation(program, "clipFrameTime"), sprite.clip_frame_time);
+			glUniform1i(glGetUniformLocation(program, "clipLoop"), sprite.clip_loop ? 1 : 0);
+		}
+		else
+		{
+			// the whole geometry as laid out in its texcoords
+			GLint frame_uloc = glGetUniformLocation(program, "atFrame");
+			GLint frame_width_uloc = glGetUniformLocation(program, "frameWidth");
+			glUniform1i(frame_uloc, 0);
+			glUniform1f(frame_width_uloc, 0.f);
+		}
 		gl_has_errors();
 		///////////////////////ANIMATION//////////////////////////
 	}
@@ -210,13 +279,11 @@ void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, int &
 
 	// Getting uniform locations for glUniform* calls
 	GLint color_uloc = glGetUniformLocation(program, "fcolor");
-	const vec3 color = registry.colors.has(entity) ? registry.colors.get(entity) : vec3(1);
-	glUniform3fv(color_uloc, 1, (float *)&color);
+	glUniform3fv(color_uloc, 1, (float *)&sprite.color);
 	gl_has_errors();
 
 	GLint opacity_uloc = glGetUniformLocation(program, "opacity");
-	const float opacity = registry.opacities.has(entity) ? registry.opacities.get(entity) : 1.f;
-	glUniform1f(opacity_uloc, opacity);
+	glUniform1f(opacity_uloc, sprite.opacity);
 	gl_has_errors();
 
 	// Get number of indices from index buffer, which has elements uint16_t
@@ -231,7 +298,7 @@ void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, int &
 	glGetIntegerv(GL_CURRENT_PROGRAM, &currProgram);
 	// Setting uniform values to the currently bound program
 	GLuint transform_loc = glGetUniformLocation(currProgram, "transform");
-	glUniformMatrix3fv(transform_loc, 1, GL_FALSE, (float *)&transform.mat);
+	glUniformMatrix3fv(transform_loc, 1, GL_FALSE, (float *)&sprite.transform);
 	GLuint projection_loc = glGetUniformLocation(currProgram, "projection");
 	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
 	gl_has_errors();
@@ -240,9 +307,65 @@ void RenderSystem::drawTexturedMesh(Entity entity, const mat3 &projection, int &
 	gl_has_errors();
 }
 
+// All particles in one instanced draw of the particle quad
+void RenderSystem::drawParticles(const std::vector<ParticleInstance> &particles, const mat3 &projection)
+{
+	if (particles.empty())
+		return;
+
+	GLsizei count = (GLsizei)std::min(particles.size(), ParticlePool::CAPACITY);
+
+	GLintptr offset = stream_buffer.upload(particles.data(), count * sizeof(ParticleInstance));
+	if (offset < 0)
+		return;
+
+	glUseProgram(m_particle_program);
+	glBindVertexArray(m_particle_VAO);
+	bindParticleInstances(offset);
+
+	GLint projection_loc = glGetUniformLocation(m_particle_program, "projection");
+	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
+	gl_has_errors();
+
+	const GLsizei num_indices = (GLsizei)meshes[(int)GEOMETRY_BUFFER_ID::PARTICLE].vertex_indices.size();
+	glDrawElementsInstanced(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, nullptr, count);
+	gl_has_errors();
+
+	// the sprites draw with the shared VAO
+	glBindVertexArray(vao);
+}
+
+void RenderSystem::drawDebug(const std::vector<DebugVertex> &vertices, const mat3 &projection)
+{
+	if (vertices.empty())
+		return;
+
+	GLintptr offset = stream_buffer.upload(vertices.data(), vertices.size() * sizeof(DebugVertex));
+	if (offset < 0)
+		return;
+
+	glUseProgram(m_debug_program);
+	glBindVertexArray(m_debug_VAO);
+	GLint in_position_loc = glGetAttribLocation(m_debug_program, "in_position");
+	GLint in_color_loc = glGetAttribLocation(m_debug_program, "in_color");
+	glVertexAttribPointer(in_position_loc, 2, GL_FLOAT, GL_FALSE, sizeof(DebugVertex),
+						  (void *)(offset + offsetof(DebugVertex, position)));
+	glVertexAttribPointer(in_color_loc, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex),
+						  (void *)(offset + offsetof(DebugVertex, color)));
+	gl_has_errors();
+
+	GLint projection_loc = glGetUniformLocation(m_debug_program, "projection");
+	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float *)&projection);
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices.size());
+	gl_has_errors();
+
+	// the sprites draw with the shared VAO
+	glBindVertexArray(vao);
+}
+
 // draw the intermediate texture to the screen, with some distortion to simulate
 // water
-void RenderSystem::drawToScreen()
+void RenderSystem::drawToScreen(const FramePacket &packet)
 {
 	glBindVertexArray(vao);
 
@@ -251,10 +374,8 @@ void RenderSystem::drawToScreen()
 	glUseProgram(effects[(GLuint)EFFECT_ASSET_ID::WATER]);
 	gl_has_errors();
 	// Clearing backbuffer
-	int w, h;
-	glfwGetFramebufferSize(window, &w, &h); // Note, this will be 2x the resolution given to glfwCreateWindow on retina displays
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, w, h);
+	glViewport(0, 0, packet.width, packet.height);
 	glDepthRange(0, 10);
 	glClearColor(1.f, 1.f, 1.f, 1.0);
 	glClearDepth(1.f);
@@ -276,9 +397,8 @@ void RenderSystem::drawToScreen()
 	// Set clock
 	GLuint time_uloc = glGetUniformLocation(water_program, "time");
 	GLuint dead_timer_uloc = glGetUniformLocation(water_program, "darken_screen_factor");
-	glUniform1f(time_uloc, (float)(glfwGetTime() * 10.0f));
-	ScreenState &screen = registry.screenStates.get(screen_state_entity);
-	glUniform1f(dead_timer_uloc, screen.darken_screen_factor);
+	glUniform1f(time_uloc, packet.time * 10.0f);
+	glUniform1f(dead_timer_uloc, packet.darken_screen_factor);
 	gl_has_errors();
 	// Set the vertex position and vertex texture coordinates (both stored in the
 	// same VBO)
@@ -301,86 +421,121 @@ void RenderSystem::drawToScreen()
 }
 
 // from simpleGl lecture 3
-void RenderSystem::renderText(const mat3 &projection)
+void RenderSystem::renderText(const std::vector<TextDraw> &texts, const mat3 &projection)
 {
 
-	// activate the shader program
-	glUseProgram(m_font_shaderProgram);
-	gl_has_errors();
-
-	for (Entity entity : registry.texts.entities)
+	// lay out the quads of every glyph first, they go up in one upload
+	m_text_vertices.clear();
+	m_text_glyphs.clear();
+	for (const TextDraw &text_component : texts)
 	{
-		// if not moving
-		if (!registry.motions.has(entity))
-		{
-			continue;
-		}
-
-		Motion &motion = registry.motions.get(entity);
-		Text &text_component = registry.texts.get(entity);
-		std::string text = text_component.info;
-		float x = motion.position.x;
-		float y = motion.position.y;
-		float scale = motion.scale.x;
-
-		GLint colorLocation = glGetUniformLocation(m_font_shaderProgram, "textColor");
-		assert(colorLocation >= 0);
-		glUniform3f(colorLocation, text_component.color.x, text_component.color.y, text_component.color.z);
-
-		GLint transformLocation = glGetUniformLocation(m_font_shaderProgram, "transform");
-		assert(transformLocation >= 0);
-		glm::mat4 p =
-			glm::mat4(1.0f); // not sure why but this works, dont try to pass in transformation matrix, won't work
-		glUniformMatrix4fv(transformLocation, 1, GL_FALSE, glm::value_ptr(p));
-		glBindVertexArray(m_font_VAO);
+		float x = text_component.position.x;
+		float y = text_component.position.y;
+		float scale = text_component.scale;
 
 		// iterate through all characters
-		std::string::const_iterator c;
-		for (c = text.begin(); c != text.end(); c++)
+		for (char c : text_component.text)
 		{
-			Character ch = m_ftCharacters[*c];
+			Character ch = m_ftCharacters[c];
 
 			float xpos = x + ch.Bearing.x * scale;
 			float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
 
 			float w = ch.Size.x * scale;
 			float h = ch.Size.y * scale;
-			// update VBO for each character
-			float vertices[6][4] = {
-				{xpos, ypos + h, 0.0f, 0.0f}, {xpos, ypos, 0.0f, 1.0f},		{xpos + w, ypos, 1.0f, 1.0f},
+			m_text_vertices.insert(m_text_vertices.end(),
+								   {{xpos, ypos + h, 0.0f, 0.0f}, {xpos, ypos, 0.0f, 1.0f}, {xpos + w, ypos, 1.0f, 1.0f},
+									{xpos, ypos + h, 0.0f, 0.0f}, {xpos + w, ypos, 1.0f, 1.0f}, {xpos + w, ypos + h, 1.0f, 0.0f}});
+			m_text_glyphs.push_back(ch.TextureID);
 
-				{xpos, ypos + h, 0.0f, 0.0f}, {xpos + w, ypos, 1.0f, 1.0f}, {xpos + w, ypos + h, 1.0f, 0.0f}};
+			// now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+			x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+		}
+	}
+	if (m_text_glyphs.empty())
+		return;
 
-			// render glyph texture over quad
-			glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-			// std::cout << "binding texture: " << ch.character << " = " << ch.TextureID << std::endl;
+	GLintptr offset = stream_buffer.upload(m_text_vertices.data(), m_text_vertices.size() * sizeof(vec4));
+	if (offset < 0)
+		return;
 
-			// update content of VBO memory
-			glBindBuffer(GL_ARRAY_BUFFER, m_font_VBO);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// activate the shader program
+	glUseProgram(m_font_shaderProgram);
+	gl_has_errors();
 
-			// render quad
-			glDrawArrays(GL_TRIANGLES, 0, 6);
+	glBindVertexArray(m_font_VAO);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)offset);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-			// now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-			x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+	GLint transformLocation = glGetUniformLocation(m_font_shaderProgram, "transform");
+	assert(transformLocation >= 0);
+	glm::mat4 p =
+		glm::mat4(1.0f); // not sure why but this works, dont try to pass in transformation matrix, won't work
+	glUniformMatrix4fv(transformLocation, 1, GL_FALSE, glm::value_ptr(p));
+
+	GLint colorLocation = glGetUniformLocation(m_font_shaderProgram, "textColor");
+	assert(colorLocation >= 0);
+
+	// glyphs have a texture each, so one draw per glyph out of the shared upload
+	GLint glyph = 0;
+	for (const TextDraw &text_component : texts)
+	{
+		glUniform3f(colorLocation, text_component.color.x, text_component.color.y, text_component.color.z);
+		for (size_t i = 0; i < text_component.text.size(); i++, glyph++)
+		{
+			// render glyph texture over quad
+			glBindTexture(GL_TEXTURE_2D, m_text_glyphs[glyph]);
+			glDrawArrays(GL_TRIANGLES, glyph * 6, 6);
 		}
-		glBindVertexArray(0);
-		glBindTexture(GL_TEXTURE_2D, 0);
 	}
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	gl_has_errors();
 }
 
 //takes game state to check current state
 void RenderSystem::draw(GAME_STATE current_state, float elapsed_ms, WorldSystem &world)
+{
+	capture_window_state();
+	FramePacket &packet = frame_packets.write_packet();
+	prepare_frame(current_state, elapsed_ms, world, packet);
+
+	// with a render thread the packet is drawn there while the next frame is simulated. The
+	// swap there waits for vsync, publish waits for the render thread to take the previous
+	// packet, so the main loop runs no faster than frames are drawn.
+	if (render_thread_running.load())
+		frame_packets.publish(std::chrono::milliseconds(100));
+	else
+		submit_frame(packet);
+}
+
+void RenderSystem::capture_window_state()
+{
+	// Note, this will be 2x the resolution given to glfwCreateWindow on retina displays
+	glfwGetFramebufferSize(window, &window_state.framebuffer_width, &window_state.framebuffer_height);
+	window_state.time = (float)glfwGetTime();
+}
+
+// Copy the texts of the registry into the packet
+static void collectTexts(FramePacket &packet)
+{
+	view(registry.texts, registry.motions).each([&](Entity, Text &text_component, Motion &motion)
+	{
+		packet.texts.push_back({text_component.info, motion.position, motion.scale.x, text_component.color});
+	});
+}
+
+void RenderSystem::prepare_frame(GAME_STATE current_state, float elapsed_ms, WorldSystem &world, FramePacket &packet)
 {
 	static GAME_STATE previous_state = GAME_STATE::MAIN_MENU;
 	static bool main_menu_initialized = false;
 
-	// Getting size of window
-	int w, h;
-	glfwGetFramebufferSize(window, &w,
-						   &h); // Note, this will be 2x the resolution given to glfwCreateWindow on retina displays
+	packet.clear();
+	packet.state = current_state;
+
+	packet.width = window_state.framebuffer_width;
+	packet.height = window_state.framebuffer_height;
+	packet.time = window_state.time;
 
 	// Handle initial setup for MAIN_MENU
 	if (!main_menu_initialized && previous_state == GAME_STATE::MAIN_MENU)
@@ -406,19 +561,75 @@ void RenderSystem::draw(GAME_STATE current_state, float elapsed_ms, WorldSystem
 			main_menu_initialized = false;
 	}
 
-	// Render menus if not in gameplay
+	// Set up projection and view matrices
+	packet.projection = createProjectionMatrix();
+	packet.ui_projection = createOrthographicProjection(packet.width, packet.height); // ortho projection for ui
+
+	// Menus if not in gameplay
 	if (current_state != GAME_STATE::GAMEPLAY)
 	{
-		renderMenu(current_state, w, h);
+		prepareMenu(current_state, packet);
 		return;
 	}
-	
+
+	sim_time_ms += elapsed_ms;
+	packet.sim_time = sim_time_ms;
+	packet.animation_time = AnimationSystem::time_ms;
+
+	auto camera = registry.cameras.entities[0];
+	mat3 view_2D = CameraSystem::createViewMatrix(camera);
+	packet.view_projection = packet.projection * view_2D;
+	packet.darken_screen_factor = registry.screenStates.get(screen_state_entity).darken_screen_factor;
+
+	// All textured meshes that have a position and size component, in render request
+	// order since that is the draw order. UI elements are drawn after them with the ortho projection
+	world_transforms.update(registry);
+	const std::vector<Entity> &drawn = world_transforms.entities();
+	const std::vector<WorldTransform> &transforms = world_transforms.transforms();
+	for (size_t i = 0; i < drawn.size(); i++)
+	{
+		if (registry.huds.has(drawn[i]))
+			continue;
+		mat3 transform = WorldTransforms::matrix(transforms[i]);
+		packet.world_sprites.push_back(makeSpriteDraw(drawn[i], transform)); //world-space elements
+	}
+
+	ParticleSystem::collectInstances(packet.particles);
+
+	for (Entity hud : registry.huds.entities)
+	{
+		mat3 transform = WorldTransforms::matrix(registry.motions.get(hud));
+		packet.ui_sprites.push_back(makeSpriteDraw(hud, transform)); // UI elements
+	}
+
+	collectTexts(packet);
+
+	// debug shapes of the last step, texts go to where their world position is on screen
+	packet.debug_vertices = debug_draw.vertices();
+	for (const TextDraw &text : debug_draw.texts())
+	{
+		vec3 clip = packet.view_projection * vec3(text.position, 1.f);
+		vec2 screen = {(clip.x + 1.f) / 2.f * window_width_px, (clip.y + 1.f) / 2.f * window_height_px};
+		packet.texts.push_back({text.text, screen, text.scale, text.color});
+	}
+}
+
+void RenderSystem::submit_frame(const FramePacket &packet)
+{
+	// Render menus if not in gameplay
+	stream_buffer.begin_frame();
+	if (packet.state != GAME_STATE::GAMEPLAY)
+	{
+		renderMenu(packet);
+		return;
+	}
+
 	// If in gameplay, proceed with normal rendering
 	// First render to the custom framebuffer
 	glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer);
 	gl_has_errors();
 	// Clearing backbuffer
-	glViewport(0, 0, w, h);
+	glViewport(0, 0, packet.width, packet.height);
 	glDepthRange(0.00001, 10);
 	glClearColor(0.13f, 0.13f, 0.13f, 1.0);
 	glClearDepth(10.f);
@@ -428,43 +639,24 @@ void RenderSystem::draw(GAME_STATE current_state, float elapsed_ms, WorldSystem
 	glDisable(GL_DEPTH_TEST);
 	gl_has_errors();
 
-	// Set up projection and view matrices
-	mat3 projection_2D = createProjectionMatrix();
-	auto camera = registry.cameras.entities[0];
-	mat3 view_2D = CameraSystem::createViewMatrix(camera);
-	mat3 pv_matrix = projection_2D * view_2D;
-	mat3 ortho_projection = createOrthographicProjection(w, h); // ortho projection for ui
-
-	// Draw all textured meshes that have a position and size component
-	for (Entity entity : registry.renderRequests.entities)
+	// one clock for every shader animated sprite of the frame
+	for (GLuint program : {m_animated_sprite_program, m_skin_sprite_program})
 	{
-		// Skip entities that don't have a motion component
-		if (!registry.motions.has(entity))
-			continue;
+		glUseProgram(program);
+		glUniform1f(glGetUniformLocation(program, "time"), packet.animation_time);
+	}
+	gl_has_errors();
 
-		int frame_current = 0;
-		GLfloat frame_width = 0;
+	for (const SpriteDraw &sprite : packet.world_sprites)
+		drawTexturedMesh(sprite, packet.view_projection);
 
-		// Handle animation if it exists
-		AnimationSystem::applyAnimation(entity, elapsed_ms, frame_current, frame_width, world);
+	drawParticles(packet.particles, packet.view_projection);
+	gpu_particles.update(packet.sim_time, PARTICLE_GRAVITY);
+	gpu_particles.draw(packet.view_projection);
+	drawDebug(packet.debug_vertices, packet.view_projection);
 
-		// Use ortho projection for UI elements, otherwise use perspective view matrix
-		if (registry.huds.has(entity))
-		{
-			continue;
-		}
-		else
-		{
-			drawTexturedMesh(entity, pv_matrix, frame_current, frame_width, elapsed_ms); //world-space elements
-		}
-	}
-
-	for (Entity hud : registry.huds.entities)
-	{
-		int frame_current = 0;
-		GLfloat frame_width = 0;
-		drawTexturedMesh(hud, ortho_projection, frame_current, frame_width, elapsed_ms); // UI elements
-	}
+	for (const SpriteDraw &sprite : packet.ui_sprites)
+		drawTexturedMesh(sprite, packet.ui_projection);
 
 	//	glUseProgram(reload_program);
 
@@ -484,15 +676,45 @@ void RenderSystem::draw(GAME_STATE current_state, float elapsed_ms, WorldSystem
 	// 
 
 	// render text
-	renderText(projection_2D);
+	renderText(packet.texts, packet.projection);
 	// Truely render to the screen
-	drawToScreen();
+	drawToScreen(packet);
+	stream_buffer.end_frame();
 
 	// Flicker-free display with a double buffer
 	glfwSwapBuffers(window);
 	gl_has_errors();
 }
 
+void RenderSystem::start_render_thread()
+{
+	if (render_thread_running.exchange(true))
+		return;
+
+	// the context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+	render_thread = std::thread([this]()
+	{
+		glfwMakeContextCurrent(window);
+		while (render_thread_running.load())
+		{
+			const FramePacket *packet = frame_packets.acquire(std::chrono::milliseconds(100));
+			if (packet)
+				submit_frame(*packet);
+		}
+		glfwMakeContextCurrent(nullptr);
+	});
+}
+
+void RenderSystem::stop_render_thread()
+{
+	if (!render_thread_running.exchange(false))
+		return;
+
+	frame_packets.interrupt();
+	render_thread.join();
+	glfwMakeContextCurrent(window);
+}
 
 mat3 RenderSystem::createProjectionMatrix()
 {
@@ -500,7 +722,6 @@ mat3 RenderSystem::createProjectionMatrix()
 	float left = 0.f;
 	float top = 0.f;
 
-	gl_has_errors();
 	float right = (float)window_width_px;
 	float bottom = (float)window_height_px;
 
@@ -525,47 +746,55 @@ mat3 RenderSystem::createOrthographicProjection(float width, float height)
 }
 
 
-void RenderSystem::renderMenu(GAME_STATE current_state, int w, int h)
+void RenderSystem::prepareMenu(GAME_STATE current_state, FramePacket &packet)
+{
+	if (cached_entities.find(current_state) == cached_entities.end())
+	{
+		LOG_WARN(LOG_CATEGORY::MENU, "No cached entities for state %d", static_cast<int>(current_state));
+		return;
+	}
+
+	bool has_text = false;
+	for (Entity entity : cached_entities[current_state])
+	{
+		if (registry.texts.has(entity))
+		{
+			// texts are drawn in one go where the first one sits in the menu
+			if (!has_text)
+				packet.menu_text_position = packet.ui_sprites.size();
+			has_text = true;
+		}
+		else if (registry.motions.has(entity) && registry.renderRequests.has(entity))
+		{
+			mat3 transform = WorldTransforms::matrix(registry.motions.get(entity));
+			packet.ui_sprites.push_back(makeSpriteDraw(entity, transform));
+		}
+	}
+
+	if (has_text)
+		collectTexts(packet);
+}
+
+void RenderSystem::renderMenu(const FramePacket &packet)
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glViewport(0, 0, w, h);
+	glViewport(0, 0, packet.width, packet.height);
 	glClearColor(0.2f, 0.2f, 0.2f, 1.0); // for debug
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	mat3 ortho_projection = createOrthographicProjection(w, h);
-
-	if (cached_entities.find(current_state) != cached_entities.end())
+	for (size_t i = 0; i <= packet.ui_sprites.size(); i++)
 	{
-		for (Entity entity : cached_entities[current_state])
-		{
-			//drawTexturedMesh(entity, ortho_projection, place_holder_int, place_holder_float, 0);
-			//  Update position dynamically based on Motion component
-			if (registry.motions.has(entity) && !registry.texts.has(entity))
-			{
-				Motion &motion = registry.motions.get(entity);
-				drawTexturedMesh(entity, ortho_projection, place_holder_int, place_holder_float,
-								 motion.position.y); // Use Motion for y-position
-			}
-			else if (registry.texts.has(entity)) {
-				mat3 projection_2D = createProjectionMatrix();
-				renderText(projection_2D);
-			}
-			else
-			{
-				// Draw without motion if not applicable
-				drawTexturedMesh(entity, ortho_projection, place_holder_int, place_holder_float, 0);
-			}
-		}
-	}
-	else
-	{
-		std::cout << "No cached entities for state: " << static_cast<int>(current_state) << std::endl;
+		if (i == packet.menu_text_position && !packet.texts.empty())
+			renderText(packet.texts, packet.projection);
+		if (i < packet.ui_sprites.size())
+			drawTexturedMesh(packet.ui_sprites[i], packet.ui_projection);
 	}
 
 	glDisable(GL_BLEND);
+	stream_buffer.end_frame();
 
 	glfwSwapBuffers(window);
 	gl_has_errors();
@@ -764,12 +993,11 @@ void RenderSystem::initializeMenuEntities(GAME_STATE state, WorldSystem &world)
 		Entity credit_entity = createMenu(TEXTURE_ASSET_ID::CREDIT_LIST, {0, 1400}, {1280, 2000});
 		cached_entities[state].push_back(credit_entity);
 		menuSystem.credits_entity = credit_entity;
-		std::cout << "Credits entity created: " << credit_entity << std::endl;
+		LOG_DEBUG(LOG_CATEGORY::MENU, "Credits entity created: %u", (unsigned int)credit_entity);
 	}
 	else if (state == GAME_STATE::SUMMARY)
 	{
-
-		std::cout << "SUMMARY............" << std::endl; // Print the line to the console (or process it)
+		LOG_DEBUG(LOG_CATEGORY::MENU, "Building the summary");
 		Entity summary_entity = createMenu(TEXTURE_ASSET_ID::SUMMARY_MENU, {0, 0}, {window_width_px, window_height_px});
 		Entity menu_button = createButton(TEXTURE_ASSET_ID::MENU_BUTTON, {0, 250}, {300, 100});
 		std::string level1line;
@@ -779,12 +1007,12 @@ void RenderSystem::initializeMenuEntities(GAME_STATE state, WorldSystem &world)
 		{
 			std::getline(inFile, level1line); // Read the single line
 			inFile.close();
-			std::cout << level1line << std::endl; // Print the line to the console (or process it)
+			LOG_INFO(LOG_CATEGORY::MENU, "%s", level1line.c_str());
 		}
 		else
 		{
 			level1line = "Level 1: --";
-			std::cerr << "Error: Could not open the file at " << score_path(0) << std::endl;
+			LOG_WARN(LOG_CATEGORY::MENU, "Could not open the file at %s", score_path(1).c_str());
 		}
 		std::string level2line;
 		std::ifstream inFile2(score_path(2)); // Open the file for reading
@@ -792,12 +1020,12 @@ void RenderSystem::initializeMenuEntities(GAME_STATE state, WorldSystem &world)
 		{
 			std::getline(inFile2, level2line); // Read the single line
 			inFile2.close();
-			std::cout << level2line << std::endl; // Print the line to the console (or process it)
+			LOG_INFO(LOG_CATEGORY::MENU, "%s", level2line.c_str());
 		}
 		else
 		{
 			level2line = "Level 2:  --";
-			std::cerr << "Error: Could not open the file at " << score_path(1) << std::endl;
+			LOG_WARN(LOG_CATEGORY::MENU, "Could not open the file at %s", score_path(2).c_str());
 		}
 		std::string level3line;
 		std::ifstream inFile3(score_path(3)); // Open the file for reading
@@ -805,12 +1033,12 @@ void RenderSystem::initializeMenuEntities(GAME_STATE state, WorldSystem &world)
 		{
 			std::getline(inFile3, level3line); // Read the single line
 			inFile3.close();
-			std::cout << level3line << std::endl; // Print the line to the console (or process it)
+			LOG_INFO(LOG_CATEGORY::MENU, "%s", level3line.c_str());
 		}
 		else
 		{
 			level3line = "Level 3: --";
-			std::cerr << "Error: Could not open the file at " << score_path(2) << std::endl;
+			LOG_WARN(LOG_CATEGORY::MENU, "Could not open the file at %s", score_path(3).c_str());
 		}
 		// bonus lvl
 		std::string level4line;
@@ -819,12 +1047,12 @@ void RenderSystem::initializeMenuEntities(GAME_STATE state, WorldSystem &world)
 		{
 			std::getline(inFile4, level4line); // Read the single line
 			inFile4.close();
-			std::cout << level4line << std::endl; // Print the line to the console (or process it)
+			LOG_INFO(LOG_CATEGORY::MENU, "%s", level4line.c_str());
 		}
 		else
 		{
 			level4line = "Secret Level: --";
-			std::cerr << "Error: Could not open the file at " << score_path(3) << std::endl;
+			LOG_WARN(LOG_CATEGORY::MENU, "Could not open the file at %s", score_path(4).c_str());
 		}
 		
 		cached_entities[state].push_back(summary_entity);
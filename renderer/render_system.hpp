@@ -7,7 +7,11 @@
 #include "engine/components.hpp"
 #include "engine/tiny_ecs.hpp"
 #include "menu/menu_system.hpp"
+#include "renderer/frame_packet.hpp"
+#include "renderer/stream_buffer.hpp"
+#include <atomic>
 #include <map>
+#include <thread>
 
 // System responsible for setting up OpenGL and for rendering all the
 // visual entities in the game
@@ -55,6 +59,9 @@ public:
 	void bindVBOandIBO(GEOMETRY_BUFFER_ID gid, std::vector<T> vertices, std::vector<uint16_t> indices);
 
 	void initializeGlTextures();
+	// Player sheets as layers of one texture array per animation geometry, after
+	// initializeGlTextures
+	void initializeSkinSheetArrays();
 
 	void initializeGlEffects();
 
@@ -62,6 +69,9 @@ public:
 	Mesh& getMesh(GEOMETRY_BUFFER_ID id) { return meshes[(int)id]; };
 
 	void initializeGlGeometryBuffers();
+	// Particle shader and the per instance buffer, after initializeGlGeometryBuffers
+	bool initParticleRendering();
+	bool initDebugDrawing();
 	// Initialize the screen texture used as intermediate render target
 	// The draw loop first renders to this texture, then it is used for the wind
 	// shader
@@ -70,14 +80,33 @@ public:
 	// Destroy resources associated to one or all entities created by the system
 	~RenderSystem();
 
-	// Draw all entities
+	// Draw all entities. Builds a frame packet and either draws it right away or hands it
+	// to the render thread when that runs. Main thread, after polling events.
 	void draw(GAME_STATE current_state, float elapsed_ms, WorldSystem &world);
+
+	// Main thread: remember the framebuffer size and the time for the next packet, draw
+	// calls it before prepare_frame
+	void capture_window_state();
+
+	// Simulation side: resolve everything to draw into packet, no GL or GLFW calls. The
+	// window state comes from the last capture_window_state.
+	void prepare_frame(GAME_STATE current_state, float elapsed_ms, WorldSystem &world, FramePacket &packet);
+	// Render side: draw a packet and swap, only GL calls
+	void submit_frame(const FramePacket &packet);
+
+	// Move the GL context to a render thread that draws the published packets, call from
+	// the main thread after init. Window events still have to be polled on the main thread,
+	// and nothing but submit_frame may make GL calls afterwards. WorldSystem::init starts
+	// it when GUNCAT_RENDER_THREAD=1 is set.
+	void start_render_thread();
+	void stop_render_thread();
 	
+	// window pixels to clip space, prepare_frame calls it so no GL calls in here
 	mat3 createProjectionMatrix();
 
 	//HUD and MENU
 	static mat3 createOrthographicProjection(float width, float height);
-	void renderMenu(GAME_STATE current_state, int w, int h);
+	void renderMenu(const FramePacket &packet);
 	Entity createMenu(TEXTURE_ASSET_ID texture_id, vec2 pos, vec2 scale);
 	Entity createMenu(const MenuElementAttributes &menu_attr);
 	Entity createButton(TEXTURE_ASSET_ID default_texture_id, vec2 pos, vec2 scale);
@@ -87,9 +116,7 @@ public:
 	void renderButtons();
 	void initializeCrosshair();
 
-	friend void initializeAnimations(RenderSystem &renderSystem);
-
-	void renderText(const mat3 &projection);
+	void renderText(const std::vector<TextDraw> &texts, const mat3 &projection);
 
 	bool fontInit();
 
@@ -98,8 +125,17 @@ public:
 
 private:
 	// Internal drawing functions for each entity type
-	void drawTexturedMesh(Entity entity, const mat3 &projection, int &atFrame, GLfloat &frameWidth, float elapsed_ms);
-	void drawToScreen();
+	void drawTexturedMesh(const SpriteDraw &sprite, const mat3 &projection);
+	void drawToScreen(const FramePacket &packet);
+	void drawParticles(const std::vector<ParticleInstance> &particles, const mat3 &projection);
+	// point the particle VAO's instance attributes at offset in the stream buffer
+	void bindParticleInstances(GLintptr offset);
+	// every debug shape of the frame in one draw
+	void drawDebug(const std::vector<DebugVertex> &vertices, const mat3 &projection);
+
+	SpriteDraw makeSpriteDraw(Entity entity, const mat3 &transform);
+	TEXTURE_ASSET_ID resolveButtonTexture(Entity entity, TEXTURE_ASSET_ID texture);
+	void prepareMenu(GAME_STATE current_state, FramePacket &packet);
 
 	// Window handle
 	GLFWwindow* window;
@@ -111,8 +147,21 @@ private:
 
 	Entity screen_state_entity;
 
-	int place_holder_int = 0;
-	GLfloat place_holder_float = 0;
+	// written by capture_window_state on the main thread
+	struct WindowState
+	{
+		int framebuffer_width = 0;
+		int framebuffer_height = 0;
+		float time = 0.f; // glfwGetTime
+	};
+	WindowState window_state;
+
+	// packets between prepare_frame and submit_frame
+	FramePacketBuffer frame_packets;
+	std::thread render_thread;
+	std::atomic<bool> render_thread_running{false};
+	// gameplay time, drives the GPU particles
+	float sim_time_ms = 0.f;
 
 	GLuint vao;
 	GLuint vbo;
@@ -121,10 +170,39 @@ private:
 	std::map<char, Character> m_ftCharacters;
 	GLuint m_font_shaderProgram;
 	GLuint m_font_VAO;
-	GLuint m_font_VBO;
+	// glyph quads of a frame and the texture of each, render thread only
+	std::vector<vec4> m_text_vertices;
+	std::vector<GLuint> m_text_glyphs;
+
+	// textured effect for animated sprites, draws a part of the sheet on the SPRITE quad and
+	// picks the frame of looping clips itself
+	GLuint m_animated_sprite_program;
+	// the same for player sheets, sampling a layer of their skin sheet array
+	GLuint m_skin_sprite_program;
+
+	// texture array per animation geometry, 0 for geometries without player sheets
+	std::array<GLuint, geometry_count> skin_sheet_arrays{};
+	// part of its array layer each player sheet covers, arrays are as large as their largest sheet
+	std::array<vec2, texture_count> skin_sheet_scales;
+
+	// Particles
+	GLuint m_particle_program;
+	GLuint m_particle_VAO;
+
+	// Debug shapes
+	GLuint m_debug_program;
+	GLuint m_debug_VAO;
+
+	// per frame vertex and instance data: text quads, particle instances
+	StreamBuffer stream_buffer;
 };
 
 bool loadEffectFromFile(
 	const std::string& vs_path, const std::string& fs_path, GLuint& out_program);
 
+// Vertex shader only program whose outputs (varyings, interleaved) are captured with
+// transform feedback
+bool loadTransformFeedbackEffect(
+	const std::string& vs_path, const std::vector<const char*>& varyings, GLuint& out_program);
+
 
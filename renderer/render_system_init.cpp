@@ -9,8 +9,13 @@
 // This creates circular header inclusion, that is quite bad.
 #include "engine/tiny_ecs_registry.hpp"
 #include "animation/animation_system.hpp"
+#include "renderer/particle_system.hpp"
+#include "renderer/gpu_particles.hpp"
+#include "engine/logger.hpp"
 
 // stlib
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <sstream>
 #include <freetype/freetype.h>
@@ -62,8 +67,15 @@ bool RenderSystem::init(GLFWwindow* window_arg)
 
 	initScreenTexture();
     initializeGlTextures();
+	initializeSkinSheetArrays();
 	initializeGlEffects();
 	initializeGlGeometryBuffers();
+	stream_buffer.init();
+	initParticleRendering();
+	initDebugDrawing();
+	gpu_particles.init(vertex_buffers[(int)GEOMETRY_BUFFER_ID::PARTICLE],
+					   index_buffers[(int)GEOMETRY_BUFFER_ID::PARTICLE],
+					   (GLsizei)meshes[(int)GEOMETRY_BUFFER_ID::PARTICLE].vertex_indices.size());
 
 	return true;
 }
@@ -257,6 +269,59 @@ void RenderSystem::initializeGlTextures()
 	gl_has_errors();
 }
 
+void RenderSystem::initializeSkinSheetArrays()
+{
+	std::vector<unsigned char> pixels;
+	for (int g = 0; g < geometry_count; g++)
+	{
+		// layers are as large as the largest sheet, smaller sheets fill their top left corner
+		int layer_count = 0;
+		ivec2 size = {0, 0};
+		for (int t = 0; t < texture_count; t++)
+		{
+			SkinSheetLayer sheet = skinSheetLayer((TEXTURE_ASSET_ID)t);
+			if (sheet.layer < 0 || (int)sheet.geometry != g)
+				continue;
+			layer_count = std::max(layer_count, sheet.layer + 1);
+			size = glm::max(size, texture_dimensions[t]);
+		}
+		if (layer_count == 0)
+			continue;
+
+		// every layer starts out transparent, the part a smaller sheet leaves over is sampled
+		// at its edges by linear filtering and would be undefined otherwise
+		pixels.assign((size_t)size.x * size.y * layer_count * 4, 0);
+		glGenTextures(1, &skin_sheet_arrays[g]);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, skin_sheet_arrays[g]);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, size.x, size.y, layer_count, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+					 pixels.data());
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		gl_has_errors();
+
+		// copied from the sheets' own textures, those stay for everything that is not a sprite
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (int t = 0; t < texture_count; t++)
+		{
+			SkinSheetLayer sheet = skinSheetLayer((TEXTURE_ASSET_ID)t);
+			if (sheet.layer < 0 || (int)sheet.geometry != g)
+				continue;
+			const ivec2 &dimensions = texture_dimensions[t];
+			pixels.resize((size_t)dimensions.x * dimensions.y * 4);
+			glBindTexture(GL_TEXTURE_2D, texture_gl_handles[t]);
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, sheet.layer, dimensions.x, dimensions.y, 1, GL_RGBA,
+							GL_UNSIGNED_BYTE, pixels.data());
+			skin_sheet_scales[t] = vec2(dimensions) / vec2(size);
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		gl_has_errors();
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
 void RenderSystem::initializeGlEffects()
 {
 	for(uint i = 0; i < effect_paths.size(); i++)
@@ -267,6 +332,13 @@ void RenderSystem::initializeGlEffects()
 		bool is_valid = loadEffectFromFile(vertex_shader_name, fragment_shader_name, effects[i]);
 		assert(is_valid && (GLuint)effects[i] != 0);
 	}
+
+	bool is_valid = loadEffectFromFile(shader_path("animated_sprite") + ".vs.glsl",
+									   shader_path("animated_sprite") + ".fs.glsl", m_animated_sprite_program);
+	assert(is_valid && m_animated_sprite_program != 0);
+	is_valid = loadEffectFromFile(shader_path("animated_sprite") + ".vs.glsl", shader_path("skin_sprite") + ".fs.glsl",
+								  m_skin_sprite_program);
+	assert(is_valid && m_skin_sprite_program != 0);
 }
 
 // One could merge the following two functions as a template function...
@@ -311,11 +383,9 @@ void RenderSystem::initializeGlGeometryBuffers()
 
 	// Index and Vertex buffer data initialization.
 	initializeGlMeshes();
-	// Initialize animations
-	initializeAnimations(*this);
 
 	//////////////////////////
-	// Initialize sprite
+	// Initialize sprite, also the quad of every animation
 	// The position corresponds to the center of the texture.
 	std::vector<TexturedVertex> textured_vertices(4);
 	textured_vertices[0].position = { -1.f/2, +1.f/2, 0.f };
@@ -404,13 +474,95 @@ void RenderSystem::initializeGlGeometryBuffers()
 	bindVBOandIBO(GEOMETRY_BUFFER_ID::SCREEN_TRIANGLE, screen_vertices, screen_indices);
 }
 
+bool RenderSystem::initParticleRendering()
+{
+	if (!loadEffectFromFile(shader_path("particle") + ".vs.glsl", shader_path("particle") + ".fs.glsl",
+							m_particle_program))
+		return false;
+
+	glGenVertexArrays(1, &m_particle_VAO);
+	glBindVertexArray(m_particle_VAO);
+
+	// the quad, shared by every instance
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffers[(int)GEOMETRY_BUFFER_ID::PARTICLE]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffers[(int)GEOMETRY_BUFFER_ID::PARTICLE]);
+	GLint in_position_loc = glGetAttribLocation(m_particle_program, "in_position");
+	assert(in_position_loc >= 0);
+	glEnableVertexAttribArray(in_position_loc);
+	glVertexAttribPointer(in_position_loc, 3, GL_FLOAT, GL_FALSE, sizeof(ColoredVertex), (void *)0);
+	gl_has_errors();
+
+	// the instances move around the stream buffer, drawParticles points them at this frame's
+	bindParticleInstances(0);
+
+	glBindVertexArray(vao);
+	return true;
+}
+
+void RenderSystem::bindParticleInstances(GLintptr offset)
+{
+	// one ParticleInstance per instance
+	glBindBuffer(GL_ARRAY_BUFFER, stream_buffer.buffer());
+
+	GLint in_offset_loc = glGetAttribLocation(m_particle_program, "in_offset");
+	GLint in_scale_loc = glGetAttribLocation(m_particle_program, "in_scale");
+	GLint in_color_loc = glGetAttribLocation(m_particle_program, "in_color");
+	assert(in_offset_loc >= 0 && in_scale_loc >= 0 && in_color_loc >= 0);
+
+	glEnableVertexAttribArray(in_offset_loc);
+	glVertexAttribPointer(in_offset_loc, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance),
+						  (void *)(offset + offsetof(ParticleInstance, position)));
+	glVertexAttribDivisor(in_offset_loc, 1);
+
+	glEnableVertexAttribArray(in_scale_loc);
+	glVertexAttribPointer(in_scale_loc, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance),
+						  (void *)(offset + offsetof(ParticleInstance, scale)));
+	glVertexAttribDivisor(in_scale_loc, 1);
+
+	glEnableVertexAttribArray(in_color_loc);
+	glVertexAttribPointer(in_color_loc, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance),
+						  (void *)(offset + offsetof(ParticleInstance, color)));
+	glVertexAttribDivisor(in_color_loc, 1);
+	gl_has_errors();
+}
+
+bool RenderSystem::initDebugDrawing()
+{
+	// same colour only fragment shader as the particles
+	if (!loadEffectFromFile(shader_path("debug_draw") + ".vs.glsl", shader_path("particle") + ".fs.glsl",
+							m_debug_program))
+		return false;
+
+	glGenVertexArrays(1, &m_debug_VAO);
+	glBindVertexArray(m_debug_VAO);
+	GLint in_position_loc = glGetAttribLocation(m_debug_program, "in_position");
+	GLint in_color_loc = glGetAttribLocation(m_debug_program, "in_color");
+	assert(in_position_loc >= 0 && in_color_loc >= 0);
+	// the pointers move with the vertices in the stream buffer, drawDebug sets them
+	glEnableVertexAttribArray(in_position_loc);
+	glEnableVertexAttribArray(in_color_loc);
+	gl_has_errors();
+
+	glBindVertexArray(vao);
+	return true;
+}
+
 RenderSystem::~RenderSystem()
 {
+	// the context has to be back on this thread before anything is deleted
+	stop_render_thread();
+
 	// Don't need to free gl resources since they last for as long as the program,
 	// but it's polite to clean after yourself.
 	glDeleteBuffers((GLsizei)vertex_buffers.size(), vertex_buffers.data());
 	glDeleteBuffers((GLsizei)index_buffers.size(), index_buffers.data());
 	glDeleteTextures((GLsizei)texture_gl_handles.size(), texture_gl_handles.data());
+	gpu_particles.destroy();
+	stream_buffer.destroy();
+	glDeleteVertexArrays(1, &m_particle_VAO);
+	glDeleteProgram(m_particle_program);
+	glDeleteVertexArrays(1, &m_debug_VAO);
+	glDeleteProgram(m_debug_program);
 	glDeleteTextures(1, &off_screen_render_buffer_color);
 	glDeleteRenderbuffers(1, &off_screen_render_buffer_depth);
 	gl_has_errors();
@@ -418,6 +570,13 @@ RenderSystem::~RenderSystem()
 	for(uint i = 0; i < effect_count; i++) {
 		glDeleteProgram(effects[i]);
 	}
+	glDeleteProgram(m_animated_sprite_program);
+	glDeleteProgram(m_skin_sprite_program);
+	for (GLuint sheet_array : skin_sheet_arrays)
+	{
+		if (sheet_array != 0)
+			glDeleteTextures(1, &sheet_array);
+	}
 	// delete allocated resources
 	glDeleteFramebuffers(1, &frame_buffer);
 	gl_has_errors();
@@ -456,19 +615,18 @@ bool RenderSystem::initScreenTexture()
 
 std::string readShaderFile(const std::string &filename)
 {
-	std::cout << "Loading shader filename: " << filename << std::endl;
+	LOG_DEBUG(LOG_CATEGORY::RENDER, "Loading shader %s", filename.c_str());
 
 	std::ifstream ifs(filename);
 
 	if (!ifs.good())
 	{
-		std::cerr << "ERROR: invalid filename loading shader from file: " << filename << std::endl;
+		LOG_ERROR(LOG_CATEGORY::RENDER, "Invalid filename loading shader from file: %s", filename.c_str());
 		return "";
 	}
 
 	std::ostringstream oss;
 	oss << ifs.rdbuf();
-	std::cout << oss.str() << std::endl;
 	return oss.str();
 }
 
@@ -492,7 +650,6 @@ bool RenderSystem::fontInit()
 
 	// font buffer setup
 	glGenVertexArrays(1, &m_font_VAO);
-	glGenBuffers(1, &m_font_VBO);
 
 	// font vertex shader
 	unsigned int font_vertexShader;
@@ -520,7 +677,6 @@ bool RenderSystem::fontInit()
 
 	GLint project_location = glGetUniformLocation(m_font_shaderProgram, "projection");
 	assert(project_location > -1);
-	std::cout << "project_location: " << project_location << std::endl;
 	glUniformMatrix4fv(project_location, 1, GL_FALSE, glm::value_ptr(projection));
 
 
@@ -532,14 +688,14 @@ bool RenderSystem::fontInit()
 	FT_Library ft;
 	if (FT_Init_FreeType(&ft))
 	{
-		std::cerr << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+		LOG_ERROR(LOG_CATEGORY::RENDER, "FreeType: could not init the library");
 		return false;
 	}
 
 	FT_Face face;
 	if (FT_New_Face(ft, font_filename.c_str(), 0, &face))
 	{
-		std::cerr << "ERROR::FREETYPE: Failed to load font: " << font_filename << std::endl;
+		LOG_ERROR(LOG_CATEGORY::RENDER, "FreeType: failed to load font %s", font_filename.c_str());
 		return false;
 	}
 
@@ -555,7 +711,7 @@ bool RenderSystem::fontInit()
 		// load character glyph
 		if (FT_Load_Char(face, c, FT_LOAD_RENDER))
 		{
-			std::cerr << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+			LOG_WARN(LOG_CATEGORY::RENDER, "FreeType: failed to load glyph %d", (int)c);
 			continue;
 		}
 
@@ -587,15 +743,9 @@ bool RenderSystem::fontInit()
 	FT_Done_Face(face);
 	FT_Done_FreeType(ft);
 
-	// bind buffers
+	// the glyph quads come from the stream buffer, renderText points the attribute at them
 	glBindVertexArray(m_font_VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_font_VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
 	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-
-	// release buffers
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 
 	return true;
@@ -617,89 +767,104 @@ bool gl_compile_shader(GLuint shader)
 
 		gl_has_errors();
 
-		fprintf(stderr, "GLSL: %s", log.data());
+		LOG_ERROR(LOG_CATEGORY::RENDER, "GLSL: %s", log.data());
 		return false;
 	}
 
 	return true;
 }
 
-bool loadEffectFromFile(
-	const std::string& vs_path, const std::string& fs_path, GLuint& out_program)
-{
-	// Opening files
-	std::ifstream vs_is(vs_path);
-	std::ifstream fs_is(fs_path);
-	if (!vs_is.good() || !fs_is.good())
+namespace {
+	struct ShaderStage
 	{
-		fprintf(stderr, "Failed to load shader files %s, %s", vs_path.c_str(), fs_path.c_str());
-		assert(false);
-		return false;
-	}
-
-	// Reading sources
-	std::stringstream vs_ss, fs_ss;
-	vs_ss << vs_is.rdbuf();
-	fs_ss << fs_is.rdbuf();
-	std::string vs_str = vs_ss.str();
-	std::string fs_str = fs_ss.str();
-	const char* vs_src = vs_str.c_str();
-	const char* fs_src = fs_str.c_str();
-	GLsizei vs_len = (GLsizei)vs_str.size();
-	GLsizei fs_len = (GLsizei)fs_str.size();
-
-	GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertex, 1, &vs_src, &vs_len);
-	GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragment, 1, &fs_src, &fs_len);
-	gl_has_errors();
+		GLenum type;
+		const std::string &path;
+	};
 
-	// Compiling
-	if (!gl_compile_shader(vertex))
+	// 0 when the file can not be read or does not compile, nothing is left behind then
+	GLuint compileShaderFile(const ShaderStage &stage)
 	{
-		fprintf(stderr, "Vertex compilation failed");
-		assert(false);
-		return false;
-	}
-	if (!gl_compile_shader(fragment))
-	{
-		fprintf(stderr, "Vertex compilation failed");
-		assert(false);
-		return false;
+		std::string source = readShaderFile(stage.path);
+		if (source.empty())
+			return 0;
+
+		const char *src = source.c_str();
+		GLsizei len = (GLsizei)source.size();
+		GLuint shader = glCreateShader(stage.type);
+		glShaderSource(shader, 1, &src, &len);
+		if (!gl_compile_shader(shader))
+		{
+			LOG_ERROR(LOG_CATEGORY::RENDER, "Compiling %s failed", stage.path.c_str());
+			return 0;
+		}
+		return shader;
 	}
 
-	// Linking
-	out_program = glCreateProgram();
-	glAttachShader(out_program, vertex);
-	glAttachShader(out_program, fragment);
-	glLinkProgram(out_program);
-	gl_has_errors();
-
+	// Compile the stages and link them into out_program, with the varyings captured by
+	// transform feedback when there are any. The shaders are deleted again whatever happens,
+	// out_program is 0 on failure.
+	bool buildProgram(std::initializer_list<ShaderStage> stages, const std::vector<const char *> &varyings,
+					  GLuint &out_program)
 	{
-		GLint is_linked = GL_FALSE;
-		glGetProgramiv(out_program, GL_LINK_STATUS, &is_linked);
-		if (is_linked == GL_FALSE)
+		out_program = 0;
+		std::vector<GLuint> shaders;
+		for (const ShaderStage &stage : stages)
 		{
-			GLint log_len;
-			glGetProgramiv(out_program, GL_INFO_LOG_LENGTH, &log_len);
-			std::vector<char> log(log_len);
-			glGetProgramInfoLog(out_program, log_len, &log_len, log.data());
+			GLuint shader = compileShaderFile(stage);
+			if (!shader)
+				break;
+			shaders.push_back(shader);
+		}
+
+		if (shaders.size() == stages.size())
+		{
+			GLuint program = glCreateProgram();
+			for (GLuint shader : shaders)
+				glAttachShader(program, shader);
+			if (!varyings.empty())
+				glTransformFeedbackVaryings(program, (GLsizei)varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+			glLinkProgram(program);
+			// No need to carry the shaders around. Keeping these objects is only useful if we
+			// recycle the same shaders over and over, which we don't.
+			for (GLuint shader : shaders)
+				glDetachShader(program, shader);
 			gl_has_errors();
 
-			fprintf(stderr, "Link error: %s", log.data());
-			assert(false);
-			return false;
+			GLint is_linked = GL_FALSE;
+			glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+			if (is_linked == GL_TRUE)
+			{
+				out_program = program;
+			}
+			else
+			{
+				GLint log_len;
+				glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_len);
+				std::vector<char> log(log_len);
+				glGetProgramInfoLog(program, log_len, &log_len, log.data());
+				LOG_ERROR(LOG_CATEGORY::RENDER, "Link error: %s", log.data());
+				glDeleteProgram(program);
+			}
 		}
-	}
 
-	// No need to carry this around. Keeping these objects is only useful if we recycle
-	// the same shaders over and over, which we don't, so no need and this is simpler.
-	glDetachShader(out_program, vertex);
-	glDetachShader(out_program, fragment);
-	glDeleteShader(vertex);
-	glDeleteShader(fragment);
-	gl_has_errors();
+		for (GLuint shader : shaders)
+			glDeleteShader(shader);
+		gl_has_errors();
+		return out_program != 0;
+	}
+}
 
-	return true;
+bool loadTransformFeedbackEffect(
+	const std::string& vs_path, const std::vector<const char*>& varyings, GLuint& out_program)
+{
+	// no fragment shader, the output is captured before rasterization
+	return buildProgram({{GL_VERTEX_SHADER, vs_path}}, varyings, out_program);
 }
 
+bool loadEffectFromFile(
+	const std::string& vs_path, const std::string& fs_path, GLuint& out_program)
+{
+	bool is_valid = buildProgram({{GL_VERTEX_SHADER, vs_path}, {GL_FRAGMENT_SHADER, fs_path}}, {}, out_program);
+	assert(is_valid);
+	return is_valid;
+}
@@ -0,0 +1,183 @@
+#include "stream_buffer.hpp"
+#include "engine/logger.hpp"
+#include "engine/swap_remove.hpp"
+
+// stlib
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+	const size_t TOTAL_SIZE = StreamBuffer::FRAMES * StreamBuffer::FRAME_CAPACITY;
+
+	bool hasBufferStorage()
+	{
+		GLint major = 0, minor = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		if (major > 4 || (major == 4 && minor >= 4))
+			return true;
+
+		GLint extensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+		for (GLint i = 0; i < extensions; i++)
+		{
+			const char *name = (const char *)glGetStringi(GL_EXTENSIONS, i);
+			if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0)
+				return true;
+		}
+		return false;
+	}
+}
+
+void StreamBuffer::init()
+{
+	const char *setting = std::getenv("GUNCAT_PERSISTENT_STREAM");
+	persistent = !(setting && std::atoi(setting) == 0) && hasBufferStorage();
+	allocate();
+
+	LOG_INFO(LOG_CATEGORY::RENDER, "Stream buffer ready, %d x %zu KiB, %s", FRAMES, FRAME_CAPACITY / 1024,
+			 mapped ? "persistently mapped" : "orphaned when busy");
+}
+
+void StreamBuffer::allocate()
+{
+	glGenBuffers(1, &gl_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, gl_buffer);
+	mapped = nullptr;
+	if (persistent)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, TOTAL_SIZE, nullptr, flags);
+		mapped = (uint8_t *)glMapBufferRange(GL_ARRAY_BUFFER, 0, TOTAL_SIZE, flags);
+	}
+	if (!mapped)
+		glBufferData(GL_ARRAY_BUFFER, TOTAL_SIZE, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	gl_has_errors();
+}
+
+void StreamBuffer::destroy()
+{
+	for (GLsync &fence : fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+	for (Retired &old : retired)
+	{
+		glDeleteSync(old.fence);
+		glDeleteBuffers(1, &old.buffer);
+	}
+	retired.clear();
+	if (mapped)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, gl_buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		mapped = nullptr;
+	}
+	glDeleteBuffers(1, &gl_buffer);
+	gl_buffer = 0;
+}
+
+void StreamBuffer::orphan()
+{
+	if (mapped)
+	{
+		// immutable storage can not be orphaned, a new buffer takes over and the old one is
+		// deleted once the GPU passed its newest fence (fences signal in order)
+		int newest = (region + FRAMES - 1) % FRAMES;
+		if (!fences[newest])
+			newest = region;
+		retired.push_back({gl_buffer, fences[newest]});
+		fences[newest] = nullptr;
+		glBindBuffer(GL_ARRAY_BUFFER, gl_buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		allocate();
+	}
+	else
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, gl_buffer);
+		glBufferData(GL_ARRAY_BUFFER, TOTAL_SIZE, nullptr, GL_STREAM_DRAW);
+	}
+
+	// the draws still in flight keep the old storage, no region of the new one is in use
+	for (GLsync &fence : fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+	orphaned++;
+}
+
+void StreamBuffer::release_retired()
+{
+	swap_remove_if(
+		retired.size(), [this](size_t i) { return glClientWaitSync(retired[i].fence, 0, 0) != GL_TIMEOUT_EXPIRED; },
+		[this](size_t i)
+		{
+			glDeleteSync(retired[i].fence);
+			glDeleteBuffers(1, &retired[i].buffer);
+			retired[i] = retired.back();
+			retired.pop_back();
+		});
+}
+
+void StreamBuffer::begin_frame()
+{
+	region = (region + 1) % FRAMES;
+	cursor = region * FRAME_CAPACITY;
+	if (!retired.empty())
+		release_retired();
+
+	GLsync &fence = fences[region];
+	if (!fence)
+		return;
+
+	// only polls, with FRAMES frames in between this has long passed. When it has not the
+	// GPU is more than FRAMES frames behind, and the buffer is replaced instead of waited on.
+	if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+	{
+		orphan();
+		return;
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+GLintptr StreamBuffer::upload(const void *data, size_t size, size_t alignment)
+{
+	size_t offset = (cursor + alignment - 1) / alignment * alignment;
+	if (offset + size > (region + 1) * FRAME_CAPACITY)
+	{
+		overflowed++;
+		return -1;
+	}
+	cursor = offset + size;
+
+	glBindBuffer(GL_ARRAY_BUFFER, gl_buffer);
+	if (mapped)
+	{
+		std::memcpy(mapped + offset, data, size);
+	}
+	else if (size > 0)
+	{
+		// the fence (or the orphaning) guarantees the GPU is done with this range
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+		void *range = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, flags);
+		if (!range)
+			return -1;
+		std::memcpy(range, data, size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	return (GLintptr)offset;
+}
+
+void StreamBuffer::end_frame()
+{
+	// a region is only fenced once per lap, begin_frame deleted the old fence
+	if (!fences[region])
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One GL buffer split into FRAMES regions for vertex and instance data that is written every
+// frame (text quads, particle instances, debug lines). A frame only writes its own region
+// and fences it when it is submitted, a region is written again once the GPU passed its
+// fence, FRAMES frames later.
+//
+// With GL 4.4 or ARB_buffer_storage the buffer is mapped once, persistently, and uploads are
+// a memcpy. On plain GL 3.3 every upload maps its range unsynchronized. Either way a region
+// whose fence has not passed yet is never waited on: on 3.3 the whole buffer is orphaned and
+// the driver hands out fresh storage, the persistent buffer can not be orphaned and is
+// replaced by a new one, the old one is deleted once the GPU is done with it.
+class StreamBuffer
+{
+public:
+	static constexpr int FRAMES = 3;
+	// bytes one frame can upload, uploads past it fail and are counted
+	static constexpr size_t FRAME_CAPACITY = 512 * 1024;
+
+	// GL thread only from here on. Turned off with GUNCAT_PERSISTENT_STREAM=0 the 3.3 path
+	// is used even when buffer storage is available.
+	void init();
+	void destroy();
+
+	// Move to the next region, at the start of a frame
+	void begin_frame();
+	// Copy size bytes into the current region and return their byte offset in buffer(),
+	// aligned to alignment. -1 when the region is full. Leaves buffer() bound to
+	// GL_ARRAY_BUFFER, buffer() can change from one frame to the next.
+	GLintptr upload(const void *data, size_t size, size_t alignment = 16);
+	// Fence the current region, after the last draw that reads it
+	void end_frame();
+
+	GLuint buffer() const { return gl_buffer; }
+	bool is_persistent() const { return mapped != nullptr; }
+
+	// metrics, never reset
+	uint64_t orphaned = 0; // the GPU was still reading the next region, the buffer was replaced
+	uint64_t overflowed = 0; // uploads that did not fit into their frame
+
+private:
+	// a persistent buffer that was replaced, until the GPU passed fence
+	struct Retired
+	{
+		GLuint buffer;
+		GLsync fence;
+	};
+
+	void allocate();
+	void orphan();
+	void release_retired();
+
+	bool persistent = false;
+	GLuint gl_buffer = 0;
+	// whole buffer, persistent path only
+	uint8_t *mapped = nullptr;
+	std::vector<Retired> retired;
+	GLsync fences[FRAMES] = {};
+	int region = FRAMES - 1;
+	size_t cursor = 0; // next free byte of the current region, from the start of the buffer
+};
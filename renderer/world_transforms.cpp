@@ -0,0 +1,56 @@
+#include "world_transforms.hpp"
+#include "engine/ecs_view.hpp"
+
+// stlib
+#include <cmath>
+
+WorldTransforms world_transforms;
+
+namespace {
+	void build(WorldTransform &transform)
+	{
+		float c = cos(transform.angle);
+		float s = sin(transform.angle);
+		transform.row0 = {transform.scale.x * c, -transform.scale.y * s, transform.position.x};
+		transform.row1 = {transform.scale.x * s, transform.scale.y * c, transform.position.y};
+	}
+}
+
+void WorldTransforms::update(ECSRegistry &reg)
+{
+	// copy the Motion values in draw order, the only pass that touches the registry
+	rows.clear();
+	drawn.clear();
+	view(reg.renderRequests, reg.motions).each_ordered(
+		[this](Entity entity, RenderRequest &, Motion &motion)
+		{
+			WorldTransform transform;
+			transform.position = motion.position;
+			transform.scale = motion.scale;
+			transform.angle = motion.angle;
+			rows.push_back(transform);
+			drawn.push_back(entity);
+		});
+
+	// one tight loop over the dense array. Rebuilding everything is cheaper than finding out
+	// what did not move, which took as many lookups per entity as this takes sin and cos.
+	for (WorldTransform &transform : rows)
+		build(transform);
+}
+
+mat3 WorldTransforms::matrix(const WorldTransform &transform)
+{
+	// column major like the rest of glm
+	return mat3(vec3(transform.row0.x, transform.row1.x, 0.f), vec3(transform.row0.y, transform.row1.y, 0.f),
+				vec3(transform.row0.z, transform.row1.z, 1.f));
+}
+
+mat3 WorldTransforms::matrix(const Motion &motion)
+{
+	WorldTransform transform;
+	transform.position = motion.position;
+	transform.scale = motion.scale;
+	transform.angle = motion.angle;
+	build(transform);
+	return matrix(transform);
+}
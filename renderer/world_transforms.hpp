@@ -0,0 +1,48 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "engine/tiny_ecs_registry.hpp"
+
+// stlib
+#include <cstdint>
+#include <vector>
+
+// Model matrix of a drawable entity as the two rows of a 2D affine transform, the same as
+// translate(position) * rotate(angle) * scale(scale), next to the Motion values it is built
+// from
+struct WorldTransform
+{
+	vec3 row0 = {1.f, 0.f, 0.f}; // scale.x * cos, -scale.y * sin, position.x
+	vec3 row1 = {0.f, 1.f, 0.f}; // scale.x * sin, scale.y * cos, position.y
+
+	vec2 position = {0.f, 0.f};
+	vec2 scale = {0.f, 0.f};
+	float angle = 0.f;
+};
+
+// The model matrices of every entity with a render request and a motion, in render request
+// (draw) order in one dense array. prepare_frame walks transforms() and entities() side by
+// side to build the world sprites of a frame.
+class WorldTransforms
+{
+public:
+	// Rebuild every matrix from the registry
+	void update(ECSRegistry &reg);
+
+	// the packed rows, in the order of entities()
+	const std::vector<WorldTransform> &transforms() const { return rows; }
+	const std::vector<Entity> &entities() const { return drawn; }
+
+	// the matrix as drawTexturedMesh uploads it
+	static mat3 matrix(const WorldTransform &transform);
+	// for the few sprites drawn outside the render request order (HUD, menus)
+	static mat3 matrix(const Motion &motion);
+
+private:
+	std::vector<WorldTransform> rows;
+	std::vector<Entity> drawn;
+};
+
+// written while preparing a frame, on the simulation thread
+extern WorldTransforms world_transforms;
@@ -0,0 +1,14 @@
+#version 330
+
+in vec2 texcoord;
+
+uniform sampler2D sampler0;
+uniform vec3 fcolor;
+uniform float opacity;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+	color = vec4(fcolor, opacity) * texture(sampler0, texcoord);
+}
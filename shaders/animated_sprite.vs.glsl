@@ -0,0 +1,35 @@
+#version 330
+
+// The SPRITE quad, in_texcoord spans [0, 1]
+in vec3 in_position;
+in vec2 in_texcoord;
+
+out vec2 texcoord;
+
+uniform mat3 transform;
+uniform mat3 projection;
+
+// part of the sheet the frame covers: u, v, width, height
+uniform vec4 uvRect;
+
+// looping clip whose frame is picked here, clipFrames is 0 to draw uvRect as it is. Times in ms.
+uniform float time;
+uniform float clipStart;
+uniform int clipFrames;
+uniform float clipFrameTime;
+uniform int clipLoop;
+
+void main()
+{
+	int frame = 0;
+	if (clipFrames > 0)
+	{
+		frame = int(max(time - clipStart, 0.0) / clipFrameTime);
+		frame = clipLoop != 0 ? frame % clipFrames : min(frame, clipFrames - 1);
+	}
+	// frames sit side by side in u
+	texcoord = uvRect.xy + vec2(in_texcoord.x + float(frame), in_texcoord.y) * uvRect.zw;
+
+	vec3 pos = projection * transform * vec3(in_position.xy, 1.0);
+	gl_Position = vec4(pos.xy, in_position.z, 1.0);
+}
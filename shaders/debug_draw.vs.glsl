@@ -0,0 +1,16 @@
+#version 330
+
+// Debug shape vertex, already in world space
+in vec2 in_position;
+in vec3 in_color;
+
+out vec3 vcolor;
+
+uniform mat3 projection;
+
+void main()
+{
+	vcolor = in_color;
+	vec3 pos = projection * vec3(in_position, 1.0);
+	gl_Position = vec4(pos.xy, 0.0, 1.0);
+}
@@ -0,0 +1,27 @@
+#version 330
+
+// Quad corner, shared by all particles
+in vec3 in_corner;
+
+// Per particle state
+in vec2 in_position;
+in vec2 in_scale;
+in vec3 in_color;
+in float in_ttl;
+
+out vec3 vcolor;
+
+uniform mat3 projection;
+
+void main()
+{
+	vcolor = in_color;
+	if (in_ttl <= 0.0)
+	{
+		// dead slot, all corners on one point outside the clip volume
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+	vec3 pos = projection * vec3(in_corner.xy * in_scale + in_position, 1.0);
+	gl_Position = vec4(pos.xy, in_corner.z, 1.0);
+}
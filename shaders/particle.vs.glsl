@@ -0,0 +1,20 @@
+#version 330
+
+// Quad corner, shared by all particles
+in vec3 in_position;
+
+// Per particle
+in vec2 in_offset;
+in vec2 in_scale;
+in vec3 in_color;
+
+out vec3 vcolor;
+
+uniform mat3 projection;
+
+void main()
+{
+	vcolor = in_color;
+	vec3 pos = projection * vec3(in_position.xy * in_scale + in_offset, 1.0);
+	gl_Position = vec4(pos.xy, in_position.z, 1.0);
+}
@@ -0,0 +1,33 @@
+#version 330
+
+// Particle state, captured back with transform feedback
+in vec2 in_position;
+in vec2 in_velocity;
+in vec2 in_scale;
+in vec3 in_color;
+in float in_ttl;
+
+out vec2 out_position;
+out vec2 out_velocity;
+out vec2 out_scale;
+out vec3 out_color;
+out float out_ttl;
+
+uniform float dt; // seconds
+uniform float gravity;
+
+void main()
+{
+	out_position = in_position;
+	out_velocity = in_velocity;
+	out_scale = in_scale;
+	out_color = in_color;
+	out_ttl = in_ttl - dt * 1000.0;
+
+	// same integration as the CPU particles
+	if (in_ttl > 0.0)
+	{
+		out_velocity.y += gravity * dt;
+		out_position += out_velocity * dt;
+	}
+}
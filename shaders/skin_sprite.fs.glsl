@@ -0,0 +1,16 @@
+#version 330
+
+in vec2 texcoord;
+
+// the sheets of every skin for one animation, one layer each
+uniform sampler2DArray sheets;
+uniform float layer;
+uniform vec3 fcolor;
+uniform float opacity;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+	color = vec4(fcolor, opacity) * texture(sheets, vec3(texcoord, layer));
+}
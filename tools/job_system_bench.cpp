@@ -0,0 +1,98 @@
+// Job system benchmark
+// Runs the same work with 0 worker threads up to the core count and prints ms per frame:
+//   integrate - integrate_motions on 100k bodies, one parallel_for
+//   frame     - one FrameJobs frame of independent systems: two integrations of 50k bodies
+//               and a world transform update of 20k sprites, none of them sharing a
+//               written container
+//
+// usage: job_system_bench [frames] [max_threads]
+
+// internal
+#include "common.hpp"
+#include "engine/job_system.hpp"
+#include "engine/motion_soa.hpp"
+#include "engine/tiny_ecs_registry.hpp"
+#include "renderer/world_transforms.hpp"
+
+// stlib
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+	const IntegrationParams PARAMS = {1.f / 60.f, 980.f};
+
+	void fill(MotionSoA &bodies, size_t count)
+	{
+		bodies.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			bodies.position_x[i] = (float)(i % 1000);
+			bodies.position_y[i] = (float)(i / 1000);
+			bodies.velocity_x[i] = 100.f;
+			bodies.velocity_y[i] = -50.f;
+			bodies.gravity_scale[i] = (float)(i % 2);
+			bodies.friction[i] = i % 3 == 0 ? 3.f : 0.f;
+		}
+	}
+
+	template <typename Fn>
+	double time_ms_per_frame(int frames, Fn &&fn)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < frames; frame++)
+			fn();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+	unsigned int max_threads = argc > 2 ? (unsigned int)std::atoi(argv[2])
+										: std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+	MotionSoA large, first, second;
+	fill(large, 100000);
+	fill(first, 50000);
+	fill(second, 50000);
+
+	ECSRegistry reg;
+	for (int i = 0; i < 20000; i++)
+	{
+		Entity entity;
+		reg.motions.emplace(entity).position = {(float)(i % 200), (float)(i / 200)};
+		reg.renderRequests.emplace(entity);
+	}
+	WorldTransforms transforms;
+
+	std::printf("%8s  %10s  %10s\n", "threads", "integrate", "frame");
+	for (unsigned int threads = 0; threads <= max_threads; threads++)
+	{
+		job_system.set_thread_count(threads);
+
+		double integrate = time_ms_per_frame(frames, [&]() { integrate_motions(large, PARAMS); });
+
+		SystemAccess first_access, second_access, transforms_access;
+		first_access.write(first);
+		second_access.write(second);
+		transforms_access.read(reg.motions).read(reg.renderRequests).write(transforms);
+		double frame = time_ms_per_frame(frames,
+										 [&]()
+										 {
+											 FrameJobs jobs;
+											 jobs.add(first_access, [&]() { integrate_motions(first, PARAMS); });
+											 jobs.add(second_access, [&]() { integrate_motions(second, PARAMS); });
+											 jobs.add(transforms_access, [&]() { transforms.update(reg); });
+											 jobs.wait_all();
+										 });
+
+		std::printf("%8u  %10.3f  %10.3f\n", threads, integrate, frame);
+	}
+
+	job_system.shutdown();
+	return 0;
+}
@@ -0,0 +1,66 @@
+// Level cooker
+// Turns every level of the LDtk project into a flat binary file that the game memory maps
+// at load time instead of parsing JSON. Run it whenever GunCat.ldtk changes, the game falls
+// back to the .ldtk for levels whose cooked file is missing or older than the project.
+//
+// usage: level_cooker [project.ldtk] [output_dir]
+
+// internal
+#include "common.hpp"
+#include "world/level_system.hpp"
+#include "engine/logger.hpp"
+
+// stlib
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+#include <LDtkLoader/Project.hpp>
+#include <LDtkLoader/World.hpp>
+
+int main(int argc, char **argv)
+{
+	std::string project_path = argc > 1 ? argv[1] : ldtk_path("GunCat.ldtk");
+	std::filesystem::path output_dir =
+		argc > 2 ? std::filesystem::path(argv[2]) : std::filesystem::path(cooked_level_path("")).parent_path();
+
+	std::error_code ec;
+	std::filesystem::create_directories(output_dir, ec);
+
+	int cooked = 0;
+	int failed = 0;
+	try
+	{
+		const ldtk::Project &project = getLDtkProject(project_path);
+
+		for (const ldtk::Level &level : project.getWorld().allLevels())
+		{
+			auto cook_start = std::chrono::high_resolution_clock::now();
+
+			LevelData data;
+			std::string out_path = (output_dir / (level.name + ".gclvl")).string();
+			if (!buildLevelDataFromLDtk(level, data) || !writeCookedLevel(out_path, data))
+			{
+				LOG_ERROR(LOG_CATEGORY::LEVEL, "Failed to cook %s", level.name.c_str());
+				failed++;
+				continue;
+			}
+
+			float cook_ms =
+				std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - cook_start).count();
+			LOG_INFO(LOG_CATEGORY::LEVEL, "Cooked %s -> %s (%u walls, %u enemies) in %.2f ms", level.name.c_str(),
+					 out_path.c_str(), data.walls.count, data.enemies.count, cook_ms);
+			cooked++;
+		}
+	}
+	catch (const std::exception &e)
+	{
+		LOG_ERROR(LOG_CATEGORY::LEVEL, "Could not read %s: %s", project_path.c_str(), e.what());
+		logger.flush();
+		return 1;
+	}
+
+	LOG_INFO(LOG_CATEGORY::LEVEL, "Cooked %d levels, %d failed", cooked, failed);
+	logger.flush();
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+// Motion integration benchmark
+// Times one integration step at 1k, 10k and 100k bodies:
+//   aos     - entity by entity over registry.motions, gravity and friction looked up per body
+//   scalar  - integrate_motions_scalar over MotionSoA
+//   simd    - integrate_motions (AVX/SSE, split across the job system from 4096 bodies)
+//   gather  - gather_motions + scatter_motions, what moving registry bodies through the SoA
+//             path costs on top of simd
+// Half the bodies have gravity and a third have friction.
+//
+// usage: motion_soa_bench [steps] [threads]
+
+// internal
+#include "common.hpp"
+#include "engine/job_system.hpp"
+#include "engine/motion_soa.hpp"
+#include "engine/tiny_ecs_registry.hpp"
+
+// stlib
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+	const float DT = 1.f / 60.f;
+	const float GRAVITY = 980.f;
+	const float FRICTION = 3.f;
+
+	template <typename Fn>
+	double time_ns_per_body(int steps, size_t bodies, Fn &&fn)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int step = 0; step < steps; step++)
+			fn();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count() / ((double)steps * bodies);
+	}
+
+	// the array of structs loop the SoA kernel replaces
+	void integrate_aos(ECSRegistry &reg)
+	{
+		for (size_t i = 0; i < reg.motions.size(); i++)
+		{
+			Entity entity = reg.motions.entities[i];
+			Motion &motion = reg.motions.components[i];
+			if (reg.gravities.has(entity))
+				motion.velocity.y += GRAVITY * DT;
+			if (reg.frictions.has(entity))
+				motion.velocity.x *= std::max(0.f, 1.f - FRICTION * DT);
+			motion.position += motion.velocity * DT;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int steps = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100;
+	if (argc > 2)
+		job_system.set_thread_count((unsigned int)std::atoi(argv[2]));
+
+	std::printf("%d worker threads, ns per body and step\n", job_system.thread_count());
+	std::printf("%8s  %8s  %8s  %8s  %8s\n", "bodies", "aos", "scalar", "simd", "gather");
+	for (size_t count : {1000, 10000, 100000})
+	{
+		ECSRegistry reg;
+		for (size_t i = 0; i < count; i++)
+		{
+			Entity entity;
+			Motion &motion = reg.motions.emplace(entity);
+			motion.position = {(float)(i % 1000), (float)(i / 1000)};
+			motion.velocity = {100.f, -50.f};
+			if (i % 2 == 0)
+				reg.gravities.emplace(entity);
+			if (i % 3 == 0)
+				reg.frictions.emplace(entity);
+		}
+
+		MotionSoA bodies;
+		gather_motions(reg, bodies, FRICTION);
+		const IntegrationParams params = {DT, GRAVITY};
+
+		double aos = time_ns_per_body(steps, count, [&]() { integrate_aos(reg); });
+		double scalar = time_ns_per_body(steps, count, [&]() { integrate_motions_scalar(bodies, params); });
+		double simd = time_ns_per_body(steps, count, [&]() { integrate_motions(bodies, params); });
+		double gather = time_ns_per_body(steps, count,
+										 [&]()
+										 {
+											 gather_motions(reg, bodies, FRICTION);
+											 scatter_motions(reg, bodies);
+										 });
+		std::printf("%8zu  %8.2f  %8.2f  %8.2f  %8.2f\n", count, aos, scalar, simd, gather);
+	}
+
+	job_system.shutdown();
+	return 0;
+}
@@ -0,0 +1,154 @@
+// Sparse set benchmark
+// Times component lookups in SparseComponentContainer against the hashed entity -> index map
+// of ComponentContainer and against a bare std::unordered_map, at a few container sizes.
+// Hits look up entities that have the component, misses look up ones that do not, which is
+// what most has() checks of a collision pass do. Churn removes and re-adds a tenth of the
+// entities.
+//
+// usage: sparse_set_bench [rounds]
+
+// internal
+#include "engine/sparse_set.hpp"
+#include "engine/tiny_ecs.hpp"
+
+// stlib
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+	struct Payload
+	{
+		float x = 0.f;
+		float y = 0.f;
+		float vx = 0.f;
+		float vy = 0.f;
+	};
+
+	// a bare hashed entity -> index map over dense arrays, no ECS around it
+	struct MapContainer
+	{
+		std::unordered_map<unsigned int, uint32_t> index;
+		std::vector<Payload> components;
+		std::vector<unsigned int> entities;
+
+		void insert(Entity e, Payload c)
+		{
+			index[e] = (uint32_t)components.size();
+			components.push_back(c);
+			entities.push_back(e);
+		}
+		bool has(Entity e) { return index.find(e) != index.end(); }
+		Payload &get(Entity e) { return components[index.find(e)->second]; }
+		void remove(Entity e)
+		{
+			auto it = index.find(e);
+			if (it == index.end())
+				return;
+			uint32_t slot = it->second;
+			index.erase(it);
+			if (slot != components.size() - 1)
+			{
+				components[slot] = components.back();
+				entities[slot] = entities.back();
+				index[entities[slot]] = slot;
+			}
+			components.pop_back();
+			entities.pop_back();
+		}
+	};
+
+	// volatile so the lookups are not optimized away
+	volatile float sink = 0.f;
+
+	template <typename Fn>
+	double time_ns_per_op(int rounds, size_t ops, Fn &&fn)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int round = 0; round < rounds; round++)
+			fn();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count() / ((double)rounds * ops);
+	}
+
+	template <typename Container>
+	double lookups(Container &container, std::vector<Entity> &probes, int rounds)
+	{
+		return time_ns_per_op(rounds, probes.size(),
+							  [&]()
+							  {
+								  float sum = 0.f;
+								  for (Entity &e : probes)
+								  {
+									  if (container.has(e))
+										  sum += container.get(e).x;
+								  }
+								  sink = sum;
+							  });
+	}
+
+	template <typename Container>
+	double churn(Container &container, std::vector<Entity> &entities, int rounds)
+	{
+		size_t count = entities.size() / 10;
+		return time_ns_per_op(rounds, count * 2,
+							  [&]()
+							  {
+								  for (size_t i = 0; i < count; i++)
+									  container.remove(entities[i]);
+								  for (size_t i = 0; i < count; i++)
+									  container.insert(entities[i], Payload());
+							  });
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int rounds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+	std::mt19937 rng(42);
+
+	std::printf("%8s  %-6s  %12s  %12s  %12s\n", "entities", "op", "sparse ns", "container ns", "map ns");
+	for (size_t count : {1000, 10000, 100000})
+	{
+		// every other entity has the component, like a container that only some entities are in
+		std::vector<Entity> all(count * 2);
+		std::vector<Entity> members;
+		std::vector<Entity> others;
+		for (size_t i = 0; i < all.size(); i++)
+			(i % 2 ? others : members).push_back(all[i]);
+		std::shuffle(members.begin(), members.end(), rng);
+		std::shuffle(others.begin(), others.end(), rng);
+
+		SparseComponentContainer<Payload> sparse;
+		ComponentContainer<Payload> container;
+		MapContainer map;
+		for (Entity &e : members)
+		{
+			sparse.insert(e, Payload());
+			container.insert(e, Payload());
+			map.insert(e, Payload());
+		}
+
+		double hit_sparse = lookups(sparse, members, rounds);
+		double hit_container = lookups(container, members, rounds);
+		double hit_map = lookups(map, members, rounds);
+		std::printf("%8zu  %-6s  %12.2f  %12.2f  %12.2f\n", count, "hit", hit_sparse, hit_container, hit_map);
+
+		double miss_sparse = lookups(sparse, others, rounds);
+		double miss_container = lookups(container, others, rounds);
+		double miss_map = lookups(map, others, rounds);
+		std::printf("%8zu  %-6s  %12.2f  %12.2f  %12.2f\n", count, "miss", miss_sparse, miss_container,
+					miss_map);
+
+		double churn_sparse = churn(sparse, members, rounds);
+		double churn_container = churn(container, members, rounds);
+		double churn_map = churn(map, members, rounds);
+		std::printf("%8zu  %-6s  %12.2f  %12.2f  %12.2f\n", count, "churn", churn_sparse, churn_container,
+					churn_map);
+	}
+	return 0;
+}
@@ -1,228 +1,605 @@
-//// Header
-//#include "world_system.hpp"
-//#include "world_init.hpp"
-//#include "level_system.hpp";
-//#include "weapons/bullet_system.hpp"
-//#include "physics/physics_system.hpp"
-//#include "weapons/weapon_system.hpp"
-//
-//
-//// stlib
-//#include <cassert>
-//#include <sstream>
-//#include <iostream>
-//#include <tuple>
-//
-//////////////////////// Load LDtk level data///////////////////////////
-//const std::string level_1 = ldtk_path("Level1.ldtk");
-//const ldtk::Level *loadLDtkFile(const std::string &filepath)
-//{
-//	try
-//	{
-//		static ldtk::Project project;
-//		project.loadFromFile(filepath);
-//
-//		const auto &world = project.getWorld();
-//		const auto &level = world.getLevel("Level_0");
-//
-//		return &level; // Return the level pointer
-//	}
-//	catch (const std::invalid_argument &e)
-//	{
-//		std::cerr << "Error loading LDtk data: " << e.what() << std::endl;
-//	}
-//	catch (const std::exception &e)
-//	{
-//		std::cerr << "Unexpected error: " << e.what() << std::endl;
-//	}
-//	return nullptr; // Return nullptr on error
-//}
-//
-//
-//// load Player position from layer
-//vec2 getPlayerPosition(const ldtk::Level *level)
-//{
-//	if (!level)
-//	{
-//		std::cerr << "Level not loaded." << std::endl;
-//		return {100, window_height_px - 400}; // Default position
-//	}
-//
-//	for (const auto &layer : level->allLayers())
-//	{
-//		if (layer.getName() == "Entities" && layer.hasEntity("Player"))
-//		{
-//			const auto &players = layer.getEntitiesByName("Player");
-//			if (!players.empty())
-//			{
-//				const auto &player = players[0].get();
-//				auto pos = player.getPosition();
-//				return {pos.x, pos.y};
-//			}
-//		}
-//	}
-//	return {100, window_height_px - 400}; // Default if Player is not found
-//}
-//// load enemy position and corresponding patrol boxes
-//// tuple (patrol_box, list_of_enemie_positions)
-//std::unordered_map<int, std::tuple<std::tuple<vec2, vec2>, std::vector<vec2>>>
-//getEnemyFlyerData(const ldtk::Level *level)
-//{
-//	std::unordered_map<int, std::tuple<std::tuple<vec2, vec2>, std::vector<vec2>>> enemyFlyerData;
-//
-//	if (!level)
-//	{
-//		std::cerr << "Level not loaded." << std::endl;
-//		return enemyFlyerData; // Return empty vector if level not loaded
-//	}
-//
-//	for (const auto &layer : level->allLayers())
-//	{
-//		if (layer.getName() == "Entities" && layer.hasEntity("Enemy_Flyer"))
-//		{
-//			const auto &enemy_flyers = layer.getEntitiesByName("Enemy_Flyer");
-//			for (const auto &entity_ref : enemy_flyers)
-//			{
-//				const auto &entity = entity_ref.get();
-//				// Extract the position using __worldX and __worldY attributes
-//				auto pos = entity.getPosition();
-//
-//				int id = entity.getField<int>("Enemy_Patrol_Box_id").value();
-//				if (enemyFlyerData.find(id) != enemyFlyerData.end())
-//				{
-//					std::get<1>(enemyFlyerData[id])
-//						.push_back(vec2{pos.x - 32.f, pos.y + 32.f}); // align with background
-//				}
-//				else
-//				{
-//					enemyFlyerData[id] = std::make_tuple(std::make_tuple(vec2{}, vec2{}),
-//														 std::vector<vec2>{vec2{pos.x - 32.f, pos.y + 32.f}});
-//				}
-//			}
-//		}
-//		if (layer.getName() == "Entities" && layer.hasEntity("Enemy_Patrol_Box"))
-//		{
-//			for (const auto &entity_ref : layer.getEntitiesByName("Enemy_Patrol_Box"))
-//			{
-//				const auto &entity = entity_ref.get();
-//				// Extract the position using __worldX and __worldY attributes
-//				auto pos = entity.getPosition();
-//				auto width = entity.getSize().x; // get size
-//				auto height = entity.getSize().y;
-//
-//				// -32px to align with background
-//				vec2 topLeft{pos.x - 32.f, pos.y - 32.f};
-//				vec2 bottomRight{pos.x + width - 32.f, pos.y + height - 32.f};
-//
-//				int id = entity.getField<int>("Enemy_Patrol_Box_id").value();
-//				if (enemyFlyerData.find(id) != enemyFlyerData.end())
-//				{
-//					std::get<0>(enemyFlyerData[id]) = std::make_tuple(topLeft, bottomRight);
-//				}
-//				else
-//				{
-//					enemyFlyerData[id] = std::make_tuple(std::make_tuple(topLeft, bottomRight), std::vector<vec2>());
-//				}
-//			}
-//		}
-//	}
-//	return enemyFlyerData;
-//}
-//
-//////////////////////// Load LDtk level data///////////////////////////
-//
-//// Reset the world state to its initial state, useful for debugging
-//void WorldSystem::restart_game(int level_index)
-//{
-//	// Debugging for memory/component leaks
-//	registry.list_all_components();
-//	printf("Restarting\n");
-//
-//	// Remove all entities that we created
-//	// All that have a motion, we could also iterate over all fish, eels, ... but that would be more cumbersome
-//	while (registry.motions.entities.size() > 0)
-//		registry.remove_all_components_of(registry.motions.entities.back());
-//
-//	// Debugging for memory/component leaks
-//	registry.list_all_components();
-//
-//	const ldtk::Level *level1 = loadLDtkFile(level_1);
-//	// float
-//	level_width = static_cast<float>(level1->size.x);
-//	// float
-//	level_height = static_cast<float>(level1->size.y);
-//	vec2 playerPosition = getPlayerPosition(level1);
-//
-//	// Create background with calculated scaling factor
-//	createBackground(renderer, {level_width / 2 - 32, level_height / 2 - 32}, {level_width, level_height});
-//
-//	// create a new Player
-//	player = createPlayer(renderer, playerPosition);
-//
-//	// crate a new Crosshair
-//	if (registry.crosshairs.size() == 0)
-//		crosshair = createCrosshair();
-//
-//
-//	create_world(&level1->getLayer("Wall"));
-//
-//	// create weapon
-//	weapon_system.set_equipped_weapon(createWeapon(renderer, {100, 100}, 200.0, 250.0, 400.0, 9, 2500.0));
-//	equipped_weapon = weapon_system.get_equipped_weapon();
-//
-//	// create enemies - location from LDtk
-//	// Retrieve all enemy flyer positions nad patrol boxes
-//	std::unordered_map<int, std::tuple<std::tuple<vec2, vec2>, std::vector<vec2>>> enemyPositions =
-//		getEnemyFlyerData(level1);
-//
-//	// Spawn each enemy at its respective position
-//	for (const auto &enemyPosition : enemyPositions)
-//	{
-//		for (auto &pos : std::get<1>(enemyPosition.second))
-//		{
-//			auto enemy = createEnemyFlyer(renderer, pos, std::get<0>(std::get<0>(enemyPosition.second)),
-//										  std::get<1>(std::get<0>(enemyPosition.second)));
-//		}
-//		// std::cout << "Spawned Enemy_Flyer at position (" << enemyPosition.x << ", " << enemyPosition.y << ")" <<
-//		// std::endl;
-//	}
-//}
-//
-//// TODO: might want to move this to a dedicated level_system file
-//
-//// void WorldSystem::create_world() {
-//// 	// floor
-//// 	createObstacle(renderer, {window_width_px / 2, window_height_px + 50}, ObstacleType::PLATFORM );
-//// 	// ceiling
-//// 	createObstacle(renderer, {window_width_px / 2, -125}, ObstacleType::PLATFORM);
-//// 	// right wall
-//// 	createObstacle(renderer, {window_width_px + 120, window_height_px - 150}, ObstacleType::WALL);
-//// 	// left wall
-//// 	createObstacle(renderer, {-130, window_height_px - 150}, ObstacleType::WALL);
-//
-//// Create Layer
-//
-//void WorldSystem::create_world(const ldtk::Layer *layer)
-//{
-//	float cell_size = layer->getCellSize();
-//
-//	vec2 cell_scale = {cell_size, cell_size};
-//	std::cout << cell_size << std::endl;
-//
-//	for (const ldtk::Tile &tile : layer->allTiles())
-//	{
-//		vec2 pos = vec2(tile.getPosition().x, tile.getPosition().y);
-//		// std::cout << pos.x << " " << pos.y << std::endl;
-//
-//		createObstacle(renderer, pos, ObstacleType::PLATFORM, cell_scale);
-//	}
-//
-//	//// floor
-//	// createFloor(renderer, {window_width_px / 2, window_height_px + 50});
-//	//// ceiling
-//	// createCeiling(renderer, {window_width_px / 2, -125});
-//	//// right wall
-//	// registry.rightWalls.emplace(createWall(renderer, {window_width_px + 120, window_height_px - 150}));
-//	//// left wall
-//	// registry.leftWalls.emplace(createWall(renderer, {-130, window_height_px - 150}));
-//}
+// Header
+#include "level_system.hpp"
+#include "world_init.hpp"
+#include "engine/logger.hpp"
+
+// stlib
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <LDtkLoader/Entity.hpp>
+#include <LDtkLoader/Layer.hpp>
+#include <LDtkLoader/Tile.hpp>
+
+LevelSystem level_system;
+
+////////////////////// Load LDtk level data///////////////////////////
+// The parsed project is kept in memory across restarts and level swaps. It is only parsed
+// again when the file on disk changed since, or after invalidateLDtkProject().
+namespace {
+	std::unique_ptr<ldtk::Project> ldtk_project;
+	std::string ldtk_project_path;
+	std::filesystem::file_time_type ldtk_project_write_time;
+}
+
+void invalidateLDtkProject()
+{
+	ldtk_project.reset();
+}
+
+const ldtk::Project &getLDtkProject(const std::string &project_path)
+{
+	std::error_code ec;
+	auto write_time = std::filesystem::last_write_time(project_path, ec);
+
+	if (ldtk_project && ldtk_project_path == project_path && (ec || write_time == ldtk_project_write_time))
+		return *ldtk_project;
+
+	auto parse_start = std::chrono::high_resolution_clock::now();
+
+	// parse into a fresh project so a failed load does not leave a half filled cache
+	auto project = std::make_unique<ldtk::Project>();
+	ldtk_project.reset();
+	project->loadFromFile(project_path);
+
+	ldtk_project = std::move(project);
+	ldtk_project_path = project_path;
+	ldtk_project_write_time = write_time;
+
+	float parse_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - parse_start).count();
+	LOG_INFO(LOG_CATEGORY::LEVEL, "Parsed %s in %.1f ms", project_path.c_str(), parse_ms);
+
+	return *ldtk_project;
+}
+
+// -32px to align with background
+static void entityBox(const ldtk::Entity &entity, vec2 &top_left, vec2 &bottom_right)
+{
+	auto pos = entity.getPosition();
+	auto size = entity.getSize();
+	top_left = {pos.x - 32.f, pos.y - 32.f};
+	bottom_right = {pos.x + size.x - 32.f, pos.y + size.y - 32.f};
+}
+
+static bool enemyTypeOf(const std::string &entity_name, ENEMY_TYPE &type)
+{
+	if (entity_name == "Enemy_Flyer")
+		type = ENEMY_TYPE::FLYER;
+	else if (entity_name == "Enemy_Boid")
+		type = ENEMY_TYPE::BOID;
+	else if (entity_name == "Enemy_Charger")
+		type = ENEMY_TYPE::CHARGER;
+	else if (entity_name == "Enemy_Boss")
+		type = ENEMY_TYPE::BOSS;
+	else
+		return false;
+	return true;
+}
+
+// the types spawn_dynamic_entities knows
+static bool isSpawnableEnemy(int32_t type)
+{
+	for (ENEMY_TYPE known : {ENEMY_TYPE::FLYER, ENEMY_TYPE::BOID, ENEMY_TYPE::CHARGER, ENEMY_TYPE::BOSS})
+	{
+		if (type == (int32_t)known)
+			return true;
+	}
+	return false;
+}
+
+static bool isSpawnableCollectable(int32_t type)
+{
+	for (COLLECTABLE_TYPE known : {COLLECTABLE_TYPE::LORE1, COLLECTABLE_TYPE::LORE2, COLLECTABLE_TYPE::LORE3,
+								   COLLECTABLE_TYPE::GRENADE_LAUNCHER})
+	{
+		if (type == (int32_t)known)
+			return true;
+	}
+	return false;
+}
+
+// index of the patrol box with this LDtk id, added with an empty box if it is not known yet
+static uint32_t patrolBoxIndex(LevelData &out, int32_t id)
+{
+	for (uint32_t i = 0; i < out.patrol_box_ids.size(); i++)
+	{
+		if (out.patrol_box_ids[i] == id)
+			return i;
+	}
+	out.patrol_box_ids.push_back(id);
+	out.patrol_box_storage.push_back({vec2{}, vec2{}, 0, 0});
+	return (uint32_t)out.patrol_box_ids.size() - 1;
+}
+
+// Flatten the LDtk level into spawn lists in a single pass over the Entities layer. The
+// storage vectors keep their capacity between levels, so this does not allocate per entity.
+bool buildLevelDataFromLDtk(const ldtk::Level &level, LevelData &out)
+{
+	out.clear();
+	out.name = level.name;
+	out.width = static_cast<float>(level.size.x);
+	out.height = static_cast<float>(level.size.y);
+
+	// collision grid
+	const ldtk::Layer &wall_layer = level.getLayer("Wall");
+	out.cell_size = static_cast<float>(wall_layer.getCellSize());
+	const auto &tiles = wall_layer.allTiles();
+	out.wall_storage.reserve(tiles.size());
+	for (const ldtk::Tile &tile : tiles)
+	{
+		out.wall_storage.push_back({vec2(tile.getPosition().x, tile.getPosition().y)});
+	}
+
+	bool player_found = false;
+	for (const auto &layer : level.allLayers())
+	{
+		if (layer.getName() != "Entities")
+			continue;
+
+		const auto &entities = layer.allEntities();
+		out.enemy_scratch.reserve(entities.size());
+		out.enemy_scratch_patrol.reserve(entities.size());
+
+		for (const ldtk::Entity &entity : entities)
+		{
+			const std::string &entity_name = entity.getName();
+			ENEMY_TYPE enemy_type;
+
+			if (entity_name == "Player")
+			{
+				if (!player_found)
+				{
+					auto pos = entity.getPosition();
+					out.player_spawn = {(float)pos.x, (float)pos.y};
+					player_found = true;
+				}
+			}
+			else if (enemyTypeOf(entity_name, enemy_type))
+			{
+				auto point = entity.getPosition();
+				vec2 pos = {point.x - 32.f, point.y - 32.f}; // align with background
+				if (enemy_type == ENEMY_TYPE::BOSS)
+				{
+					// boss uses top left corner point as pivot, apply offset
+					pos.x += ENEMY_BOSS_BB_WIDTH / 2;
+					pos.y += ENEMY_BOSS_BB_HEIGHT / 2 + 5.f;
+				}
+				else if (enemy_type == ENEMY_TYPE::CHARGER)
+				{
+					// chargers use bottom center as pivot, apply offset
+					pos.y -= ENEMY_CHARGER_BB_HEIGHT / 2;
+				}
+
+				int32_t id = entity.getField<int>("Enemy_Patrol_Box_id").value();
+				out.enemy_scratch.push_back({(int32_t)enemy_type, pos});
+				out.enemy_scratch_patrol.push_back(patrolBoxIndex(out, id));
+			}
+			else if (entity_name == "Enemy_Patrol_Box")
+			{
+				LOG_DEBUG(LOG_CATEGORY::LEVEL, "loading patrol box");
+				int32_t id = entity.getField<int>("Enemy_Patrol_Box_id").value();
+				uint32_t index = patrolBoxIndex(out, id);
+				PatrolBoxSpawn &box = out.patrol_box_storage[index];
+				entityBox(entity, box.top_left, box.bottom_right);
+			}
+			else if (entity_name == "Collectable")
+			{
+				auto pos = entity.getPosition();
+				int type = entity.getField<int>("type").value_or(-1);
+				// cooked files with unknown types are rejected, so they are never written
+				if (!isSpawnableCollectable(type))
+				{
+					LOG_WARN(LOG_CATEGORY::LEVEL, "skipping collectable of unknown type %d", type);
+					continue;
+				}
+				out.collectable_storage.push_back({type, {(float)pos.x, (float)pos.y}});
+			}
+			else if (entity_name == "Level_Exit")
+			{
+				LOG_DEBUG(LOG_CATEGORY::LEVEL, "loading exit box");
+				LevelExitSpawn exit;
+				exit.to_level = entity.getField<int>("to_level").value();
+				entityBox(entity, exit.top_left, exit.bottom_right);
+				out.exit_storage.push_back(exit);
+			}
+			else if (entity_name == "Alpha_Box")
+			{
+				LOG_DEBUG(LOG_CATEGORY::LEVEL, "loading alpha box");
+				AlphaBoxSpawn alpha_box;
+				alpha_box.alpha = entity.getField<float>("alpha").value();
+				entityBox(entity, alpha_box.top_left, alpha_box.bottom_right);
+				out.alpha_box_storage.push_back(alpha_box);
+			}
+			else if (entity_name == "Kill_Box")
+			{
+				LOG_DEBUG(LOG_CATEGORY::LEVEL, "loading kill box");
+				KillBoxSpawn kill_box;
+				kill_box.damage = entity.getField<int>("damage").value();
+				entityBox(entity, kill_box.top_left, kill_box.bottom_right);
+				out.kill_box_storage.push_back(kill_box);
+			}
+		}
+		break;
+	}
+
+	// group the enemies by patrol box so each box owns a contiguous range
+	out.enemy_storage.reserve(out.enemy_scratch.size());
+	for (uint32_t box = 0; box < out.patrol_box_storage.size(); box++)
+	{
+		PatrolBoxSpawn &patrol_box = out.patrol_box_storage[box];
+		patrol_box.first_enemy = (uint32_t)out.enemy_storage.size();
+		for (size_t i = 0; i < out.enemy_scratch.size(); i++)
+		{
+			if (out.enemy_scratch_patrol[i] == box)
+				out.enemy_storage.push_back(out.enemy_scratch[i]);
+		}
+		patrol_box.enemy_count = (uint32_t)out.enemy_storage.size() - patrol_box.first_enemy;
+	}
+
+	out.bind_storage();
+	return true;
+}
+
+////////////////////// Level data ///////////////////////////
+
+template <typename T>
+static SpawnSpan<T> span_of(const std::vector<T> &storage)
+{
+	return {storage.data(), (uint32_t)storage.size()};
+}
+
+void LevelData::bind_storage()
+{
+	walls = span_of(wall_storage);
+	patrol_boxes = span_of(patrol_box_storage);
+	enemies = span_of(enemy_storage);
+	collectables = span_of(collectable_storage);
+	exits = span_of(exit_storage);
+	alpha_boxes = span_of(alpha_box_storage);
+	kill_boxes = span_of(kill_box_storage);
+}
+
+void LevelData::clear()
+{
+	// keep the vectors' capacity around for the next level
+	wall_storage.clear();
+	patrol_box_storage.clear();
+	enemy_storage.clear();
+	collectable_storage.clear();
+	exit_storage.clear();
+	alpha_box_storage.clear();
+	kill_box_storage.clear();
+	patrol_box_ids.clear();
+	enemy_scratch.clear();
+	enemy_scratch_patrol.clear();
+	cooked_file.close();
+	bind_storage();
+}
+
+////////////////////// Cooked levels ///////////////////////////
+// A cooked level is a header followed by the spawn arrays, in the order of the counts in
+// the header. Every record is a multiple of 4 bytes so all arrays stay aligned.
+namespace {
+	const char COOKED_MAGIC[4] = {'G', 'C', 'L', 'V'};
+	const uint32_t COOKED_VERSION = 1;
+
+	struct CookedHeader
+	{
+		char magic[4];
+		uint32_t version;
+		float width;
+		float height;
+		float cell_size;
+		vec2 player_spawn;
+		uint32_t wall_count;
+		uint32_t patrol_box_count;
+		uint32_t enemy_count;
+		uint32_t collectable_count;
+		uint32_t exit_count;
+		uint32_t alpha_box_count;
+		uint32_t kill_box_count;
+	};
+
+	static_assert(sizeof(vec2) == 2 * sizeof(float), "cooked levels expect a tightly packed vec2");
+	static_assert(sizeof(CookedHeader) % 4 == 0, "cooked header must keep the arrays aligned");
+
+	template <typename T>
+	void write_array(std::ofstream &file, const SpawnSpan<T> &span)
+	{
+		file.write(reinterpret_cast<const char *>(span.data), sizeof(T) * span.count);
+	}
+
+	// point span at the next count records of the file, false if the file is too short
+	template <typename T>
+	bool read_array(const uint8_t *&cursor, const uint8_t *end, uint32_t count, SpawnSpan<T> &span)
+	{
+		size_t bytes = sizeof(T) * (size_t)count;
+		if ((size_t)(end - cursor) < bytes)
+			return false;
+		span.data = reinterpret_cast<const T *>(cursor);
+		span.count = count;
+		cursor += bytes;
+		return true;
+	}
+
+	// everything spawn_dynamic_entities indexes or casts without checking
+	bool spawns_valid(const LevelData &level)
+	{
+		for (const PatrolBoxSpawn &box : level.patrol_boxes)
+		{
+			if (box.enemy_count > level.enemies.count || box.first_enemy > level.enemies.count - box.enemy_count)
+				return false;
+		}
+		for (const EnemySpawn &enemy : level.enemies)
+		{
+			if (!isSpawnableEnemy(enemy.type))
+				return false;
+		}
+		for (const CollectableSpawn &collectable : level.collectables)
+		{
+			if (!isSpawnableCollectable(collectable.type))
+				return false;
+		}
+		return true;
+	}
+}
+
+std::string cooked_level_path(const std::string &level_name)
+{
+	return ldtk_path("cooked/" + level_name + ".gclvl");
+}
+
+bool writeCookedLevel(const std::string &path, const LevelData &level)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR(LOG_CATEGORY::LEVEL, "Could not open %s for writing", path.c_str());
+		return false;
+	}
+
+	CookedHeader header;
+	std::memcpy(header.magic, COOKED_MAGIC, sizeof(header.magic));
+	header.version = COOKED_VERSION;
+	header.width = level.width;
+	header.height = level.height;
+	header.cell_size = level.cell_size;
+	header.player_spawn = level.player_spawn;
+	header.wall_count = level.walls.count;
+	header.patrol_box_count = level.patrol_boxes.count;
+	header.enemy_count = level.enemies.count;
+	header.collectable_count = level.collectables.count;
+	header.exit_count = level.exits.count;
+	header.alpha_box_count = level.alpha_boxes.count;
+	header.kill_box_count = level.kill_boxes.count;
+
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	write_array(file, level.walls);
+	write_array(file, level.patrol_boxes);
+	write_array(file, level.enemies);
+	write_array(file, level.collectables);
+	write_array(file, level.exits);
+	write_array(file, level.alpha_boxes);
+	write_array(file, level.kill_boxes);
+
+	return file.good();
+}
+
+bool loadCookedLevel(const std::string &path, LevelData &out)
+{
+	out.clear();
+	if (!out.cooked_file.open(path))
+		return false;
+
+	const uint8_t *cursor = out.cooked_file.data();
+	const uint8_t *end = cursor + out.cooked_file.size();
+
+	CookedHeader header;
+	if (out.cooked_file.size() < sizeof(header))
+	{
+		out.clear();
+		return false;
+	}
+	std::memcpy(&header, cursor, sizeof(header));
+	cursor += sizeof(header);
+
+	if (std::memcmp(header.magic, COOKED_MAGIC, sizeof(header.magic)) != 0 || header.version != COOKED_VERSION)
+	{
+		LOG_WARN(LOG_CATEGORY::LEVEL, "%s is not a version %u cooked level", path.c_str(), COOKED_VERSION);
+		out.clear();
+		return false;
+	}
+
+	out.width = header.width;
+	out.height = header.height;
+	out.cell_size = header.cell_size;
+	out.player_spawn = header.player_spawn;
+
+	bool complete = read_array(cursor, end, header.wall_count, out.walls) &&
+					read_array(cursor, end, header.patrol_box_count, out.patrol_boxes) &&
+					read_array(cursor, end, header.enemy_count, out.enemies) &&
+					read_array(cursor, end, header.collectable_count, out.collectables) &&
+					read_array(cursor, end, header.exit_count, out.exits) &&
+					read_array(cursor, end, header.alpha_box_count, out.alpha_boxes) &&
+					read_array(cursor, end, header.kill_box_count, out.kill_boxes);
+	if (!complete)
+	{
+		LOG_WARN(LOG_CATEGORY::LEVEL, "%s is truncated", path.c_str());
+		out.clear();
+		return false;
+	}
+	if (!spawns_valid(out))
+	{
+		LOG_WARN(LOG_CATEGORY::LEVEL, "%s has an enemy range or spawn type out of bounds", path.c_str());
+		out.clear();
+		return false;
+	}
+
+	return true;
+}
+
+////////////////////// Memory mapping ///////////////////////////
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+							  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	file_handle = file;
+	mapping_handle = mapping;
+	bytes = static_cast<const uint8_t *>(view);
+	length = (size_t)file_size.QuadPart;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (bytes)
+		UnmapViewOfFile(bytes);
+	if (mapping_handle)
+		CloseHandle((HANDLE)mapping_handle);
+	if (file_handle)
+		CloseHandle((HANDLE)file_handle);
+	bytes = nullptr;
+	length = 0;
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+}
+#else
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void *view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps the file alive
+	::close(fd);
+	if (view == MAP_FAILED)
+		return false;
+
+	bytes = static_cast<const uint8_t *>(view);
+	length = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (bytes)
+		munmap(const_cast<uint8_t *>(bytes), length);
+	bytes = nullptr;
+	length = 0;
+}
+#endif
+
+////////////////////// Level system ///////////////////////////
+
+const LevelData *LevelSystem::load_level(const std::string &level_name)
+{
+	auto load_start = std::chrono::high_resolution_clock::now();
+
+	// only trust the cooked file when it is at least as new as the LDtk project
+	std::string cooked_path = cooked_level_path(level_name);
+	std::error_code cooked_ec, project_ec;
+	auto cooked_time = std::filesystem::last_write_time(cooked_path, cooked_ec);
+	auto project_time = std::filesystem::last_write_time(project_path, project_ec);
+
+	if (!cooked_ec && (project_ec || cooked_time >= project_time))
+	{
+		if (loadCookedLevel(cooked_path, current))
+		{
+			current.name = level_name;
+			float load_ms =
+				std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - load_start).count();
+			LOG_INFO(LOG_CATEGORY::LEVEL, "%s loaded from cooked file in %.2f ms", level_name.c_str(), load_ms);
+			return &current;
+		}
+		LOG_WARN(LOG_CATEGORY::LEVEL, "Could not load %s, falling back to LDtk", cooked_path.c_str());
+	}
+	else if (!cooked_ec)
+	{
+		LOG_WARN(LOG_CATEGORY::LEVEL, "%s is older than the LDtk project, loading from LDtk", cooked_path.c_str());
+	}
+
+	try
+	{
+		const ldtk::Project &project = getLDtkProject(project_path);
+		const ldtk::Level &level = project.getWorld().getLevel(level_name);
+		buildLevelDataFromLDtk(level, current);
+	}
+	catch (const std::invalid_argument &e)
+	{
+		LOG_ERROR(LOG_CATEGORY::LEVEL, "Error loading LDtk data: %s", e.what());
+		return nullptr;
+	}
+	catch (const std::exception &e)
+	{
+		LOG_ERROR(LOG_CATEGORY::LEVEL, "Unexpected error: %s", e.what());
+		return nullptr;
+	}
+
+	float load_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - load_start).count();
+	LOG_INFO(LOG_CATEGORY::LEVEL, "%s loaded from LDtk in %.2f ms", level_name.c_str(), load_ms);
+	return &current;
+}
+
+void LevelSystem::invalidate()
+{
+	current.clear();
+	invalidateLDtkProject();
+}
@@ -1,26 +1,176 @@
-//#include <LDtkLoader/Project.hpp>
-//#include <LDtkLoader/Level.hpp>
-//#include <LDtkLoader/Layer.hpp>
-//#include <LDtkLoader/Tile.hpp>
-//#include <LDtkLoader/Entity.hpp>
-//
-//class Level_System
-//{
-//	public:
-//	Level_System();
-//	~Level_System();
-//
-//	// Load level from file
-//	const ldtk::Level *load_level(const std::string &filepath);
-//
-//	// Get player position from level
-//	vec2 get_player_position(const ldtk::Level *level);
-//
-//	// Get enemy flyer data from level
-//	std::unordered_map<int, std::tuple<std::tuple<vec2, vec2>, std::vector<vec2>>>
-//	get_enemy_flyer_data(const ldtk::Level *level);
-//};
-//
-//extern Level_System level_system;
-//
-//extern std::vector<std::string> level_paths;
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "engine/components.hpp"
+
+// stlib
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <LDtkLoader/Level.hpp>
+#include <LDtkLoader/Project.hpp>
+
+// Flat spawn records for one level. The same layout is used in memory and in the cooked
+// level files, so a memory mapped file can be read in place. Positions are already
+// aligned with the background (-32px).
+struct WallTileSpawn
+{
+	vec2 position;
+};
+
+struct PatrolBoxSpawn
+{
+	vec2 top_left;
+	vec2 bottom_right;
+	// range into the enemy list
+	uint32_t first_enemy;
+	uint32_t enemy_count;
+};
+
+struct EnemySpawn
+{
+	int32_t type; // ENEMY_TYPE
+	vec2 position;
+};
+
+struct CollectableSpawn
+{
+	int32_t type; // COLLECTABLE_TYPE
+	vec2 position;
+};
+
+struct LevelExitSpawn
+{
+	int32_t to_level;
+	vec2 top_left;
+	vec2 bottom_right;
+};
+
+struct AlphaBoxSpawn
+{
+	float alpha;
+	vec2 top_left;
+	vec2 bottom_right;
+};
+
+struct KillBoxSpawn
+{
+	int32_t damage;
+	vec2 top_left;
+	vec2 bottom_right;
+};
+
+// Read only view over an array of spawn records
+template <typename T>
+struct SpawnSpan
+{
+	const T *data = nullptr;
+	uint32_t count = 0;
+
+	const T *begin() const { return data; }
+	const T *end() const { return data + count; }
+	const T &operator[](uint32_t i) const { return data[i]; }
+	uint32_t size() const { return count; }
+};
+
+// Read only memory mapping of a whole file
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool open(const std::string &path);
+	void close();
+
+	const uint8_t *data() const { return bytes; }
+	size_t size() const { return length; }
+	bool is_open() const { return bytes != nullptr; }
+
+private:
+	const uint8_t *bytes = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	void *file_handle = nullptr;
+	void *mapping_handle = nullptr;
+#endif
+};
+
+// Collision grid and spawn lists of a level in flat arrays. The spans either point into
+// the vectors below (built from LDtk) or into a memory mapped cooked file.
+struct LevelData
+{
+	std::string name;
+	float width = 0.f;
+	float height = 0.f;
+	float cell_size = 0.f;
+	vec2 player_spawn = {100, window_height_px - 400};
+
+	SpawnSpan<WallTileSpawn> walls;
+	SpawnSpan<PatrolBoxSpawn> patrol_boxes;
+	SpawnSpan<EnemySpawn> enemies;
+	SpawnSpan<CollectableSpawn> collectables;
+	SpawnSpan<LevelExitSpawn> exits;
+	SpawnSpan<AlphaBoxSpawn> alpha_boxes;
+	SpawnSpan<KillBoxSpawn> kill_boxes;
+
+	// backing storage when built from LDtk
+	std::vector<WallTileSpawn> wall_storage;
+	std::vector<PatrolBoxSpawn> patrol_box_storage;
+	std::vector<EnemySpawn> enemy_storage;
+	std::vector<CollectableSpawn> collectable_storage;
+	std::vector<LevelExitSpawn> exit_storage;
+	std::vector<AlphaBoxSpawn> alpha_box_storage;
+	std::vector<KillBoxSpawn> kill_box_storage;
+
+	// scratch space for buildLevelDataFromLDtk, reused between levels
+	std::vector<int32_t> patrol_box_ids;
+	std::vector<EnemySpawn> enemy_scratch;
+	std::vector<uint32_t> enemy_scratch_patrol;
+
+	// backing storage when loaded from a cooked file
+	MappedFile cooked_file;
+
+	// point the spans at the storage vectors
+	void bind_storage();
+	void clear();
+};
+
+// Parsed LDtk project, kept in memory across restarts and level swaps. It is only parsed
+// again when the file on disk changed since, or after invalidateLDtkProject(). The file is
+// only looked at when a level is loaded, i.e. on a level change or after F5, restarting
+// the loaded level keeps its data and never gets here. Parsing again
+// replaces the project, so references or pointers into it (ldtk::Level, ldtk::Entity...)
+// must not be kept across calls, fetch them again from the returned project.
+const ldtk::Project &getLDtkProject(const std::string &project_path);
+void invalidateLDtkProject();
+
+// Fill out with the level's data read from the LDtk project
+bool buildLevelDataFromLDtk(const ldtk::Level &level, LevelData &out);
+
+// Cooked level files
+bool writeCookedLevel(const std::string &path, const LevelData &level);
+bool loadCookedLevel(const std::string &path, LevelData &out);
+std::string cooked_level_path(const std::string &level_name);
+
+class LevelSystem
+{
+public:
+	// Load a level, from its cooked file when there is an up to date one, otherwise from
+	// the LDtk project. The returned data stays valid until the next load_level call.
+	const LevelData *load_level(const std::string &level_name);
+
+	// Drop the cached LDtk project and the mapped level
+	void invalidate();
+
+	std::string project_path = ldtk_path("GunCat.ldtk");
+
+private:
+	LevelData current;
+};
+
+extern LevelSystem level_system;
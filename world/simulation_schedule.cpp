@@ -0,0 +1,76 @@
+#include "simulation_schedule.hpp"
+#include "animation/animation_system.hpp"
+#include "engine/destruction_queue.hpp"
+#include "engine/entity_handle.hpp"
+#include "engine/registry_containers.hpp"
+#include "engine/transform_hierarchy.hpp"
+#include "renderer/debug_draw.hpp"
+#include "renderer/gpu_particles.hpp"
+#include "world/world_init.hpp"
+
+// stlib
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+void SimulationSchedule::configure_threads(bool render_thread)
+{
+	if (std::getenv("GUNCAT_JOB_THREADS"))
+		return;
+
+	unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+	unsigned int reserved = render_thread ? 2 : 1;
+	job_system.set_thread_count(cores > reserved ? cores - reserved : 0);
+}
+
+SystemAccess SimulationSchedule::world_step_access(const WorldSystem &world)
+{
+	// gameplay, level swaps and respawns touch about everything, collisions spawn particles
+	SystemAccess access;
+	for_each_container([&access](auto member) { access.write(registry.*member); });
+	access.write(world)
+		.write(transform_hierarchy)
+		.write(entity_handles)
+		.write(enemy_health_bars)
+		.write(destruction_queue)
+		.write(debug_draw)
+		.write(particle_pool)
+		.write(gpu_particles);
+	return access;
+}
+
+SystemAccess SimulationSchedule::animation_access(const WorldSystem &world)
+{
+	SystemAccess access;
+	access.read(registry.motions)
+		.read(registry.players)
+		.read(registry.enemies)
+		.read(registry.weapons)
+		.read(registry.grenades)
+		.read(registry.cameras)
+		.read(world)
+		.write(registry.animations)
+		.write(registry.renderRequests)
+		.write(animation_frames);
+	return access;
+}
+
+SystemAccess SimulationSchedule::particle_access()
+{
+	SystemAccess access;
+	access.write(particle_pool);
+	return access;
+}
+
+bool SimulationSchedule::step(float elapsed_ms, WorldSystem &world, ParticleSystem &particles)
+{
+	bool world_running = true;
+	// GLFW input and the window title, this one stays on the main thread
+	jobs.run_here(world_step_access(world), [&]() { world_running = world.step(elapsed_ms); });
+
+	jobs.add(animation_access(world), [elapsed_ms, &world]() { AnimationSystem::step(elapsed_ms, world); });
+	jobs.add(particle_access(), [elapsed_ms, &particles]() { particles.step(elapsed_ms); });
+
+	jobs.wait_all();
+	return world_running;
+}
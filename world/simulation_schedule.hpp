@@ -0,0 +1,47 @@
+#pragma once
+
+// internal
+#include "engine/job_system.hpp"
+#include "renderer/particle_system.hpp"
+#include "world/world_system.hpp"
+
+// The simulation systems of one tick, run through FrameJobs. Every system declares the
+// containers it reads and writes, the ones that share a written container run in the order
+// they are added and the others side by side:
+//
+//   world step (main thread) -> animation step
+//                            -> particle update
+//
+// The model matrices are built once per frame by prepare_frame, after the menus had their
+// turn, so they are not a job here.
+//
+// What runs in parallel: animation and particles side by side, and the
+// particle integration split across threads once the pool holds 4096 particles. The world
+// step, with the enemy AI, and gameplay Motion integration in PhysicsSystem stay on the
+// main thread. Moving physics here needs PhysicsSystem to integrate through
+// gather_motions / integrate_motions / scatter_motions first.
+//
+// main's loop replaces
+//   world.step(elapsed_ms); AnimationSystem::step(elapsed_ms, world); particles.step(elapsed_ms);
+// with
+//   schedule.step(elapsed_ms, world, particles);
+// keeping its return value where it used world.step's. physics.step and
+// world.handle_collisions stay where they are, after it.
+class SimulationSchedule
+{
+public:
+	// Size the job system for the cores left over by the main thread and, with render_thread,
+	// the render thread. GUNCAT_JOB_THREADS from the environment still wins. Call it before
+	// the first step.
+	static void configure_threads(bool render_thread);
+
+	// Returns what WorldSystem::step returned, the other systems run either way
+	bool step(float elapsed_ms, WorldSystem &world, ParticleSystem &particles);
+
+	static SystemAccess world_step_access(const WorldSystem &world);
+	static SystemAccess animation_access(const WorldSystem &world);
+	static SystemAccess particle_access();
+
+private:
+	FrameJobs jobs;
+};
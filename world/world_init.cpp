@@ -1,5 +1,9 @@
 #include "world_init.hpp"
 #include "engine/tiny_ecs_registry.hpp"
+#include "engine/logger.hpp"
+#include "engine/destruction_queue.hpp"
+#include "engine/transform_hierarchy.hpp"
+#include "animation/animation_clips.hpp"
 #include "iostream"
 
 Entity createPlayer(RenderSystem* renderer, vec2 pos, Skin selected_skin)
@@ -33,54 +37,15 @@ Entity createPlayer(RenderSystem* renderer, vec2 pos, Skin selected_skin)
 
 	registry.players.emplace(entity);
 
-	// create an empty Player component for our character
-	switch (selected_skin)
-	{
-	case Skin::DEFAULT:
-		registry.renderRequests.insert(entity,{TEXTURE_ASSET_ID::CAT_IDLE, EFFECT_ASSET_ID::TEXTURED, GEOMETRY_BUFFER_ID::CAT_IDLE});
-		break;
-	case Skin::CAT_SKIN_XMAS:
-		registry.renderRequests.insert(entity, {TEXTURE_ASSET_ID::CAT_IDLE_XMAS, EFFECT_ASSET_ID::TEXTURED, GEOMETRY_BUFFER_ID::CAT_IDLE});
-		break;
-	case Skin::CAT_SKIN_SLIME:
-		registry.renderRequests.insert(
-			entity, {TEXTURE_ASSET_ID::CAT_IDLE_SLIME, EFFECT_ASSET_ID::TEXTURED, GEOMETRY_BUFFER_ID::CAT_IDLE});
-		break;
-	case Skin::CAT_SKIN_SCH:
-		registry.renderRequests.insert(
-			entity, {TEXTURE_ASSET_ID::CAT_IDLE_SCH_ALIVE, EFFECT_ASSET_ID::TEXTURED, GEOMETRY_BUFFER_ID::CAT_IDLE});
-		break;
-	case Skin::CAT_SKIN_RAINBOW:
-		registry.renderRequests.insert(
-			entity, {TEXTURE_ASSET_ID::CAT_IDLE_RAINBOW, EFFECT_ASSET_ID::TEXTURED, GEOMETRY_BUFFER_ID::CAT_IDLE});
-		break;
-	}
-	
+	// start on the skin's idle sheet
+	const AnimationClip *idle = findAnimationClip(ANIMATED_KIND::PLAYER, selected_skin, IDLE);
+	registry.renderRequests.insert(entity, {idle->texture, EFFECT_ASSET_ID::TEXTURED, idle->geometry});
 
 	registry.opacities.emplace(entity, 1.0f);
 
 	return entity;
 }
 
-Entity createLine(vec2 position, vec2 scale)
-{
-	Entity entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object (the value is stored in the resource cache)
-	registry.renderRequests.insert(
-		entity, {TEXTURE_ASSET_ID::TEXTURE_COUNT, EFFECT_ASSET_ID::EGG, GEOMETRY_BUFFER_ID::DEBUG_LINE});
-
-	// Create motion
-	Motion &motion = registry.motions.emplace(entity);
-	motion.angle = 0.f;
-	motion.velocity = {0, 0};
-	motion.position = position;
-	motion.scale = scale;
-
-	registry.debugComponents.emplace(entity);
-	return entity;
-}
-
 std::vector<ObstacleProps> obstacleProps = {
 	{vec2({WALL_BB_WIDTH, WALL_BB_HEIGHT}), TEXTURE_ASSET_ID::WALL}, // WALL
 	{vec2({FLOOR_BB_WIDTH, FLOOR_BB_HEIGHT}), TEXTURE_ASSET_ID::FLOOR} // PLATFORM
@@ -168,11 +133,17 @@ Entity createWeapon(RenderSystem *renderer, vec2 pos, float damage, float rate_o
 	return entity;
 }
 
-std::vector<Entity> createEnemyHealthBar(vec2 pos) 
+SparseComponentContainer<EnemyHealthBarHandles> enemy_health_bars;
+
+// both bars hang above the enemy and follow it through transform_hierarchy
+std::vector<Entity> createEnemyHealthBar(Entity enemy, const Motion &enemy_motion)
 {
 	auto inner_entity = Entity();
 	auto outer_entity = Entity();
 
+	vec2 offset = {0.f, -abs(enemy_motion.scale.y) / 2};
+	vec2 pos = enemy_motion.position + offset;
+
 	registry.motions.emplace(inner_entity, Motion{pos, 0.f, {0.f, 0.f}, {77.f, 6.f}, 0.f});
 	registry.renderRequests.insert(
 		inner_entity, {TEXTURE_ASSET_ID::ENEMY_HEALTH_BAR_INNER, EFFECT_ASSET_ID::TEXTURED, GEOMETRY_BUFFER_ID::SPRITE});
@@ -184,9 +155,28 @@ std::vector<Entity> createEnemyHealthBar(vec2 pos)
 		{TEXTURE_ASSET_ID::ENEMY_HEALTH_BAR_OUTER, EFFECT_ASSET_ID::TEXTURED, GEOMETRY_BUFFER_ID::SPRITE});
 	registry.enemyHealthBars.emplace(outer_entity);
 
+	transform_hierarchy.attach(inner_entity, enemy, offset);
+	transform_hierarchy.attach(outer_entity, enemy, offset);
+
+	enemy_health_bars.remove(enemy);
+	enemy_health_bars.insert(enemy, {entity_handles.acquire(inner_entity), entity_handles.acquire(outer_entity)});
+
 	return {inner_entity, outer_entity};
 }
 
+void destroyEnemyHealthBar(Entity enemy)
+{
+	if (!enemy_health_bars.has(enemy))
+		return;
+
+	const EnemyHealthBarHandles &bars = enemy_health_bars.get(enemy);
+	if (entity_handles.is_alive(bars.inner))
+		destruction_queue.push(entity_handles.get(bars.inner));
+	if (entity_handles.is_alive(bars.outer))
+		destruction_queue.push(entity_handles.get(bars.outer));
+	enemy_health_bars.remove(enemy);
+}
+
 Entity createEnemyFlyer(vec2 pos, vec2 left_point, vec2 right_point)
 { 
 	auto entity = Entity();
@@ -204,7 +194,7 @@ Entity createEnemyFlyer(vec2 pos, vec2 left_point, vec2 right_point)
 	registry.patrolBoxes.emplace(entity, PatrolBox{left_point, right_point});
 	registry.deadlys.emplace(entity, Deadly{1});
 
-	auto health_bar_entities = createEnemyHealthBar(pos - vec2{0.f, abs(motion.scale.y) / 2});
+	auto health_bar_entities = createEnemyHealthBar(entity, motion);
 	registry.enemies.emplace(entity,
 							 Enemy{ENEMY_TYPE::FLYER, random_float(0.f, PATROL_TURN_WAIT),
 								   random_float(0.f, SLIME_SHOOT_COOLDOWN), false, 
@@ -237,7 +227,7 @@ Entity createEnemyBoid(vec2 pos, vec2 left_point, vec2 right_point)
 	registry.healths.emplace(entity);
 	registry.boidEnemies.emplace(entity);
 
-	auto health_bar_entities = createEnemyHealthBar(pos - vec2{0.f, abs(motion.scale.y) / 2});
+	auto health_bar_entities = createEnemyHealthBar(entity, motion);
 	registry.enemies.emplace(entity, 
 							 Enemy{ENEMY_TYPE::BOID, 
 							 0.f, 
@@ -271,7 +261,7 @@ Entity createEnemyCharger(vec2 pos, vec2 left_point, vec2 right_point)
 
 	registry.deadlys.emplace(entity, Deadly{1});
 
-	auto health_bar_entities = createEnemyHealthBar(pos - vec2{0.f, abs(motion.scale.y) / 2});
+	auto health_bar_entities = createEnemyHealthBar(entity, motion);
 	registry.enemies.emplace(
 		entity, Enemy{ENEMY_TYPE::CHARGER, 0.f, 0.f, false, health_bar_entities[0], health_bar_entities[1], 38.f, {0.f, 10.f}});
 	registry.healths.emplace(entity);
@@ -366,7 +356,7 @@ Entity createText(std::string info, vec2 pos, float scale, vec3 color)
 	Text &text = registry.texts.emplace(entity);
 	text.info = info;
 	text.color = color;
-	std::cout << "TEXT COMPONENT LENGTH" << registry.texts.size() << std::endl;
+	LOG_DEBUG(LOG_CATEGORY::WORLD, "text component count %zu", registry.texts.size());
 
 	Motion &motion = registry.motions.emplace(entity);
 	motion.position = pos;
@@ -2,6 +2,8 @@
 
 #include "common.hpp"
 #include "engine/tiny_ecs.hpp"
+#include "engine/entity_handle.hpp"
+#include "engine/sparse_set.hpp"
 #include "renderer/render_system.hpp"
 
 // These are hardcoded to the dimensions of the entity texture
@@ -43,7 +45,6 @@ struct ObstacleProps
 // Define a vector of obstacle properties, indexed by ObstacleType
 extern std::vector<ObstacleProps> obstacleProps;
 
-Entity createLine(vec2 position, vec2 size);
 // the player
 Entity createPlayer(RenderSystem *renderer, vec2 pos, Skin selected_skin);
 
@@ -64,9 +65,19 @@ Entity createEnemyBoid(vec2 pos, vec2 left_point, vec2 right_point);
 Entity createEnemyCharger(vec2 pos, vec2 left_point, vec2 right_point);
 Entity createEnemyBoss(vec2 pos, vec2 left_point, vec2 right_point);
 
-Entity createBackground(RenderSystem *renderer, vec2 pos, vec2 scale, TEXTURE_ASSET_ID level_bg);
+// the two health bars of an enemy, by enemy. The bars can be removed before the enemy, the
+// handles notice that where the plain ids in Enemy do not.
+struct EnemyHealthBarHandles
+{
+	EntityHandle inner;
+	EntityHandle outer;
+};
+extern SparseComponentContainer<EnemyHealthBarHandles> enemy_health_bars;
 
-Entity createLine(vec2 position, vec2 scale);
+// queue both health bars of enemy for removal, bars that are gone already are skipped
+void destroyEnemyHealthBar(Entity enemy);
+
+Entity createBackground(RenderSystem *renderer, vec2 pos, vec2 scale, TEXTURE_ASSET_ID level_bg);
 
 Entity createLevelExit(int index, vec2 left_point, vec2 right_point);
 
@@ -3,7 +3,7 @@
 #include "world_system.hpp"
 #include "world_init.hpp"
 #include "HUD/hud_system.hpp"
-#include "level_system.hpp";
+#include "level_system.hpp"
 #include "player/player_input_system.hpp"
 
 // stlib
@@ -11,7 +11,6 @@
 #include <sstream>
 #include <string>
 #include <iostream>
-#include <tuple>
 #include <cmath>      // For sin and cos
 #include <cstdlib>    // For rand and srand
 #include <ctime>      // For seeding random numbers
@@ -25,8 +24,15 @@
 #include "weapons/weapon_system.hpp"
 #include "menu/menu_system.hpp"
 #include "renderer/particle_system.hpp"
+#include "renderer/gpu_particles.hpp"
+#include "renderer/debug_draw.hpp"
+#include "world/simulation_schedule.hpp"
 #include "main.h"
 #include "player/player_input_system.hpp"
+#include "engine/logger.hpp"
+#include "engine/destruction_queue.hpp"
+#include "engine/ecs_view.hpp"
+#include "engine/swap_remove.hpp"
 
 constexpr float TILE_PIXEL = 64.f;
 //float level_height;
@@ -38,314 +44,6 @@ bool isRestarting = false;
 std::chrono::time_point<std::chrono::high_resolution_clock> level_start_time;
 float level_elapsed_time = 0.0f;
 
-////////////////////// Load LDtk level data///////////////////////////
-const ldtk::Level *loadLDtkFile(const std::string level_name, const std::string &project_path = ldtk_path("GunCat.ldtk"))
-{
-	try
-	{
-		static ldtk::Project project;
-		project.loadFromFile(project_path);
-
-		const auto &world = project.getWorld();
-		const auto &level = world.getLevel(level_name);
-
-		return &level; // Return the level pointer
-	}
-	catch (const std::invalid_argument &e)
-	{
-		std::cerr << "Error loading LDtk data: " << e.what() << std::endl;
-	}
-	catch (const std::exception &e)
-	{
-		std::cerr << "Unexpected error: " << e.what() << std::endl;
-	}
-	return nullptr; // Return nullptr on error
-}
-
-
-// load Player position from layer
-vec2 getPlayerPosition(const ldtk::Level *level)
-{
-	if (!level)
-	{
-		std::cerr << "Level not loaded." << std::endl;
-		return {100, window_height_px - 400}; // Default position
-	}
-
-	for (const auto &layer : level->allLayers())
-	{
-		if (layer.getName() == "Entities" && layer.hasEntity("Player"))
-		{
-			const auto &players = layer.getEntitiesByName("Player");
-			if (!players.empty())
-			{
-				const auto &player = players[0].get();
-				auto pos = player.getPosition();
-				return {pos.x, pos.y};
-			}
-		}
-	}
-	return {100, window_height_px - 400}; // Default if Player is not found
-}
-
-// Load collectable spawns
-std::vector<std::tuple<COLLECTABLE_TYPE, vec2>> getCollectablePos(const ldtk::Level *level)
-{
-	std::vector<std::tuple<COLLECTABLE_TYPE, vec2>> collectables; // This is the output vector
-
-	for (const auto &layer : level->allLayers())
-	{
-		if (layer.getName() == "Entities" && layer.hasEntity("Collectable"))
-		{
-			const auto &entities = layer.getEntitiesByName("Collectable");
-			for (const auto &collectable_ref : entities) 
-			{
-				const auto &entity = collectable_ref.get();
-				auto pos_ref = entity.getPosition();
-				vec2 pos = {pos_ref.x, pos_ref.y};
-				int type = entity.getField<int>("type").value_or(-1); 
-				collectables.push_back(std::make_tuple((COLLECTABLE_TYPE)type, pos));
-			}
-		}
-	}
-
-	return collectables; // Ensure you return the populated vector
-}
-
-// load enemy position and corresponding patrol boxes
-// tuple (patrol_box, list of tuple(enemy type, enemy position))
-std::unordered_map<int, std::tuple<std::tuple<vec2, vec2>, std::vector<std::tuple<ENEMY_TYPE, vec2>>>> getEnemySpawnData(const ldtk::Level *level)
-{
-	std::unordered_map<int, std::tuple<std::tuple<vec2, vec2>, std::vector<std::tuple<ENEMY_TYPE, vec2>>>> enemySpawnData;
-
-	if (!level)
-	{
-		std::cerr << "Level not loaded." << std::endl;
-		return enemySpawnData; // Return empty vector if level not loaded
-	}
-
-	bool flyers_populated = false;
-	bool boids_populated = false;
-	bool chargers_populated = false;
-	bool boss_populated = false;
-
-	auto populate_data = [&](auto &enemies, ENEMY_TYPE enemy_type)
-	{
-		for (const auto &entity_ref : enemies)
-		{
-			const auto &entity = entity_ref.get();
-			// Extract the position using __worldX and __worldY attributes
-			auto point = entity.getPosition();
-			vec2 pos = {point.x - 32.f, point.y - 32.f}; // align with background
-			if (enemy_type == ENEMY_TYPE::BOSS)
-			{
-				// boss uses top left corner point as pivot, apply offset
-				pos.x += ENEMY_BOSS_BB_WIDTH / 2;
-				pos.y += ENEMY_BOSS_BB_HEIGHT / 2 + 5.f;
-			}
-			else if (enemy_type == ENEMY_TYPE::CHARGER)
-			{
-				// chargers use bottom center as pivot, apply offset
-				pos.y -= ENEMY_CHARGER_BB_HEIGHT / 2;
-			}
-
-			int id = entity.getField<int>("Enemy_Patrol_Box_id").value();
-			if (enemySpawnData.find(id) != enemySpawnData.end())
-			{
-				std::get<1>(enemySpawnData[id]).push_back(std::make_tuple(enemy_type, pos));
-			}
-			else
-			{
-				enemySpawnData[id] =
-					std::make_tuple(std::make_tuple(vec2{}, vec2{}),
-									std::vector<std::tuple<ENEMY_TYPE, vec2>>{std::make_tuple(enemy_type, pos)});
-			}
-		}
-	};
-
-	for (const auto &layer : level->allLayers())
-	{
-		if (layer.getName() != "Entities")
-		{
-			continue;
-		}
-
-		if (layer.hasEntity("Enemy_Patrol_Box"))
-		{
-			for (const auto &entity_ref : layer.getEntitiesByName("Enemy_Patrol_Box"))
-			{
-				std::cout << "loading patrol box" << std::endl;
-				const auto &entity = entity_ref.get();
-				// Extract the position using __worldX and __worldY attributes
-				auto pos = entity.getPosition();
-				auto width = entity.getSize().x; // get size
-				auto height = entity.getSize().y;
-
-				// -32px to align with background
-				vec2 topLeft{pos.x - 32.f, pos.y - 32.f};
-				vec2 bottomRight{pos.x + width - 32.f, pos.y + height - 32.f};
-
-				int id = entity.getField<int>("Enemy_Patrol_Box_id").value();
-				if (enemySpawnData.find(id) != enemySpawnData.end())
-				{
-					std::get<0>(enemySpawnData[id]) = std::make_tuple(topLeft, bottomRight);
-				}
-				else
-				{
-					enemySpawnData[id] = std::make_tuple(std::make_tuple(topLeft, bottomRight),
-														 std::vector<std::tuple<ENEMY_TYPE, vec2>>());
-				}
-			}
-		}
-
-		if (layer.hasEntity("Enemy_Flyer") && !flyers_populated)
-		{
-			const auto &enemy_flyers = layer.getEntitiesByName("Enemy_Flyer");
-			populate_data(enemy_flyers, ENEMY_TYPE::FLYER);
-			flyers_populated = true;
-		}
-		if (layer.hasEntity("Enemy_Boid") && !boids_populated)
-		{
-			const auto &enemy_boids = layer.getEntitiesByName("Enemy_Boid");
-			populate_data(enemy_boids, ENEMY_TYPE::BOID);
-			boids_populated = true;
-		}
-		if (layer.hasEntity("Enemy_Charger") && !chargers_populated)
-		{
-			const auto &enemy_chargers = layer.getEntitiesByName("Enemy_Charger");
-			populate_data(enemy_chargers, ENEMY_TYPE::CHARGER);
-			chargers_populated = true;
-		}
-		if (layer.hasEntity("Enemy_Boss") && !boss_populated)
-		{
-			const auto &enemy_boss = layer.getEntitiesByName("Enemy_Boss");
-			populate_data(enemy_boss, ENEMY_TYPE::BOSS);
-			boss_populated = true;
-		}
-
-		break;
-	}
-	return enemySpawnData;
-}
-
-//load level exit
-std::vector<std::tuple<int, std::tuple<vec2,vec2>>> getLevelExits(const ldtk::Level *level) {
-	std::vector<std::tuple<int, std::tuple<vec2, vec2>>> exits;
-	for (const auto &layer : level->allLayers())
-	{
-		if (layer.getName() == "Entities" && layer.hasEntity("Level_Exit"))
-		{
-			for (const auto &entity_ref : layer.getEntitiesByName("Level_Exit"))
-			{
-				std::cout << "loading exit box" << std::endl;
-				const auto &entity = entity_ref.get();
-				// Extract the position using __worldX and __worldY attributes
-				auto pos = entity.getPosition();
-				auto width = entity.getSize().x; // get size
-				auto height = entity.getSize().y;
-
-				// -32px to align with background
-				vec2 topLeft{pos.x - 32.f, pos.y - 32.f};
-				vec2 bottomRight{pos.x + width - 32.f, pos.y + height - 32.f};
-
-				int index = entity.getField<int>("to_level").value();
-				exits.push_back(std::make_tuple(index, std::make_tuple(topLeft, bottomRight)));
-			}
-		}
-	}
-	return exits;
-}
-
-// load alpha box
-std::vector<std::tuple<float, std::tuple<vec2, vec2>>> getAlphaBox(const ldtk::Level *level)
-{
-	std::vector<std::tuple<float, std::tuple<vec2, vec2>>> alpha_boxes;
-	for (const auto &layer : level->allLayers())
-	{
-		if (layer.getName() == "Entities" && layer.hasEntity("Alpha_Box"))
-		{
-			for (const auto &entity_ref : layer.getEntitiesByName("Alpha_Box"))
-			{
-				std::cout << "loading alpha box" << std::endl;
-				const auto &entity = entity_ref.get();
-				// Extract the position using __worldX and __worldY attributes
-				auto pos = entity.getPosition();
-				auto width = entity.getSize().x; // get size
-				auto height = entity.getSize().y;
-
-				// -32px to align with background
-				vec2 topLeft{pos.x - 32.f, pos.y - 32.f};
-				vec2 bottomRight{pos.x + width - 32.f, pos.y + height - 32.f};
-
-				float alpha = entity.getField<float>("alpha").value();
-				alpha_boxes.push_back(std::make_tuple(alpha, std::make_tuple(topLeft, bottomRight)));
-			}
-		}
-	}
-	return alpha_boxes;
-}
-
-
-// load kill box
-std::vector<std::tuple<int, std::tuple<vec2, vec2>>> getKillBox(const ldtk::Level *level)
-{
-	std::vector<std::tuple<int, std::tuple<vec2, vec2>>> kill_boxes;
-	for (const auto &layer : level->allLayers())
-	{
-		if (layer.getName() == "Entities" && layer.hasEntity("Kill_Box"))
-		{
-			for (const auto &entity_ref : layer.getEntitiesByName("Kill_Box"))
-			{
-				std::cout << "loading kill box" << std::endl;
-				const auto &entity = entity_ref.get();
-				// Extract the position using __worldX and __worldY attributes
-				auto pos = entity.getPosition();
-				auto width = entity.getSize().x; // get size
-				auto height = entity.getSize().y;
-
-				// -32px to align with background
-				vec2 topLeft{pos.x - 32.f, pos.y - 32.f};
-				vec2 bottomRight{pos.x + width - 32.f, pos.y + height - 32.f};
-
-				int damage = entity.getField<int>("damage").value();
-				kill_boxes.push_back(std::make_tuple(damage, std::make_tuple(topLeft, bottomRight)));
-			}
-		}
-	}
-	return kill_boxes;
-}
-
-//// load pickup box
-//std::vector<std::tuple<int, std::tuple<vec2, vec2>>> getPickupBox(const ldtk::Level *level)
-//{
-//	std::vector<std::tuple<int, std::tuple<vec2, vec2>>> pickup_boxes;
-//	for (const auto &layer : level->allLayers())
-//	{
-//		if (layer.getName() == "Entities" && layer.hasEntity("PickUp_Box"))
-//		{
-//			for (const auto &entity_ref : layer.getEntitiesByName("Pickup_Box"))
-//			{
-//				std::cout << "loading kill box" << std::endl;
-//				const auto &entity = entity_ref.get();
-//				// Extract the position using __worldX and __worldY attributes
-//				auto pos = entity.getPosition();
-//				auto width = entity.getSize().x; // get size
-//				auto height = entity.getSize().y;
-//
-//				// -32px to align with background
-//				vec2 topLeft{pos.x - 32.f, pos.y - 32.f};
-//				vec2 bottomRight{pos.x + width - 32.f, pos.y + height - 32.f};
-//
-//				int type = entity.getField<int>("type").value();
-//				pickup_boxes.push_back(std::make_tuple(type, std::make_tuple(topLeft, bottomRight)));
-//			}
-//		}
-//	}
-//	return pickup_boxes;
-//}
-
-
-////////////////////// Load LDtk level data///////////////////////////
 
 
 // create the world
@@ -467,6 +165,16 @@ void WorldSystem::init(RenderSystem* renderer_arg) {
 	fprintf(stderr, "Loaded music\n");
 
 	curr_level = -1;
+
+	// GUNCAT_RENDER_THREAD=1 draws each frame on a render thread while the next tick is
+	// simulated, the GL context moves there for good
+	const char *render_thread_setting = std::getenv("GUNCAT_RENDER_THREAD");
+	bool render_thread = render_thread_setting && std::atoi(render_thread_setting) != 0;
+	if (render_thread)
+		renderer->start_render_thread();
+
+	// worker threads for the simulation schedule, before the first job starts them
+	SimulationSchedule::configure_threads(render_thread);
 	// Set all states to default
     //restart_game();
 
@@ -486,16 +194,16 @@ void WorldSystem::init(RenderSystem* renderer_arg) {
 
 //Create Layer
 
-void WorldSystem::create_world(const ldtk::Layer* layer)
+void WorldSystem::create_world(const LevelData &level)
 {
-	float cell_size = layer->getCellSize();
+	float cell_size = level.cell_size;
 
 	vec2 cell_scale = {cell_size, cell_size};
-	std::cout << cell_size << std::endl;
+	LOG_DEBUG(LOG_CATEGORY::LEVEL, "wall cell size %.1f", cell_size);
 	
-	for (const ldtk::Tile &tile : layer->allTiles())
+	for (const WallTileSpawn &tile : level.walls)
 	{
-		vec2 pos = vec2(tile.getPosition().x, tile.getPosition().y);
+		vec2 pos = tile.position;
 		//std::cout << pos.x << " " << pos.y << std::endl;
 
 		createObstacle(renderer, pos, ObstacleType::PLATFORM , cell_scale);
@@ -539,7 +247,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 	Motion &player_motion = registry.motions.get(player);
 	if (player_motion.position.y > level_height || player_motion.position.y < 0)
 	{
-		restart_game();
+		respawn();
 		return false;
 	}
 
@@ -580,8 +288,8 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 				/*std::cout << "pause time: " << menuSystem.total_pause_duration << std::endl;
 				std::cout << "total time: " << level_elapsed_time << std::endl;*/
 
-				std::cout << "current level index: " << curr_level << std::endl;
-				std::cout << "next level index: " << level_index << std::endl;
+				LOG_INFO(LOG_CATEGORY::LEVEL, "current level index: %d", curr_level);
+				LOG_INFO(LOG_CATEGORY::LEVEL, "next level index: %d", level_index);
 
 				// 0 based
 				std::ofstream outFile(score_path(curr_level + 1));
@@ -591,14 +299,14 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 					if (curr_level == 3)
 					{
 						outFile << "Secret Level" << ": " << level_elapsed_time << " seconds\n";
-						std::cout << "Secret level unlocked" << std::endl;
+						LOG_INFO(LOG_CATEGORY::LEVEL, "Secret level unlocked");
 					}
 					else
 					{
 						outFile << "Level " << curr_level + 1 << ": " << level_elapsed_time << " seconds\n";
 					}
 
-					std::cout << "saving to file: " << score_path(curr_level + 1) << std::endl;
+					LOG_INFO(LOG_CATEGORY::LEVEL, "saving to file: %s", score_path(curr_level + 1).c_str());
 					
 					outFile.close();
 
@@ -607,7 +315,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 				}
 				else
 				{
-					std::cerr << "Error: Could not open file to save level time.\n";
+					LOG_ERROR(LOG_CATEGORY::LEVEL, "Could not open file to save level time.");
 				}
 
 				return false;
@@ -616,49 +324,23 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 	}
 
 	// Remove debug info from the last step
-	while (registry.debugComponents.entities.size() > 0)
-		registry.remove_all_components_of(registry.debugComponents.entities.back());
-	float line_width = 4.0f;
+	debug_draw.clear();
 	if (debugging.in_debug_mode)
 	{
 		for (Entity &entity : registry.enemies.entities)
 		{
 			Motion &motion = registry.motions.get(entity);
-			float height = abs(motion.scale.y);
-			float width = abs(motion.scale.x);
-			Entity Line1 = createLine(motion.position + vec2(0, height / 2), {width, line_width});
-			Entity Line2 = createLine(motion.position + vec2(0, (-height / 2)), {width, line_width});
-			Entity Line3 = createLine(motion.position + vec2(width / 2, 0), {line_width, height});
-			Entity Line4 = createLine(motion.position + vec2(-width / 2, 0), {line_width, height});
+			debug_draw.box(motion.position, motion.scale);
 		}
 
 		PhysicsSystem physicsSystem;
 		Motion &player_motion = registry.motions.get(player);
 		vec2 player_bounding_box = physicsSystem.get_bounding_box_2(player_motion);
+		debug_draw.box(player_motion.position, {player_bounding_box.x, player_bounding_box.x});
 
-
-		Entity e1 = createLine(player_motion.position + vec2(0, player_bounding_box.x / 2), {player_bounding_box.x, line_width});
-
-		Entity e2 = createLine(player_motion.position - vec2(0, player_bounding_box.x / 2), {player_bounding_box.x, line_width});
-	
-		Entity e3 = createLine(player_motion.position - vec2(player_bounding_box.x / 2, 0),
-							 {line_width, player_bounding_box.x});
- 
-		Entity e4 = createLine(player_motion.position + vec2(player_bounding_box.x / 2, 0),
-							 {line_width, player_bounding_box.x});
-	 
 		// patrol box debug lines
 		for (PatrolBox &box : registry.patrolBoxes.components)
-		{
-			float height = box.bottom_right_point.y - box.top_left_point.y;
-			float width = box.bottom_right_point.x - box.top_left_point.x;
-			Entity top = createLine(box.top_left_point + vec2(width / 2, 0), {width, line_width});
-			Entity bottom = createLine(vec2(box.top_left_point.x, box.bottom_right_point.y) + vec2(width / 2, 0),
-									   {width, line_width});
-			Entity right = createLine(vec2(box.bottom_right_point.x, box.top_left_point.y) + vec2(0, height / 2),
-									  {line_width, height});
-			Entity left = createLine(box.top_left_point + vec2(0, height / 2), {line_width, height});
-		}
+			debug_draw.box((box.top_left_point + box.bottom_right_point) / 2.f, box.bottom_right_point - box.top_left_point);
 	}
 
 	// Process DeathTimers
@@ -675,42 +357,43 @@ bool WorldSystem::step(float elapsed_ms_since_last_update)
 		if (timer.time_remaining <= 0.0f)
 		{
 			// Remove the entity after the death timer expires
-			registry.remove_all_components_of(entity);
+			destruction_queue.push(entity);
 		}
 	}
+	destruction_queue.flush(registry);
+
+	// a pickup is a checkpoint, saved after the picked up entity is gone and only if the player survived
+	if (checkpoint_requested && registry.players.has(player) && !registry.players.get(player).is_dead)
+		save_checkpoint();
+	checkpoint_requested = false;
 
 	//if player is dead true, press enter to restart
 	if (registry.players.has(player) && registry.players.get(player).is_dead && (glfwGetKey(window, GLFW_KEY_ENTER) == GLFW_PRESS))
 	{
-		restart_game();
+		respawn();
 	}
 
-	// update enemy health bar positions
-	for (auto& entity : registry.enemies.entities)
-	{
-		if (registry.deathTimers.has(entity))
-			continue;
-		
-		auto &enemy = registry.enemies.get(entity);
-		if (enemy.enemy_type == ENEMY_TYPE::BULLET || enemy.enemy_type == ENEMY_TYPE::BOSS)
-			continue;
-
-		auto &motion = registry.motions.get(entity);
-		if (length(motion.velocity) < 1.f)
-			continue;
-
-		auto &inner_bar_motion = registry.motions.get(enemy.health_bar_inner);
-		auto &outer_bar_motion = registry.motions.get(enemy.health_bar_outer);
-		auto &enemy_health = registry.healths.get(entity);
+	// the bars follow their enemy through transform_hierarchy, only the fill changes here
+	view(registry.enemies, registry.healths).without(registry.deathTimers).each(
+		[](Entity entity, Enemy &enemy, Health &enemy_health)
+		{
+			if (enemy.enemy_type == ENEMY_TYPE::BULLET || enemy.enemy_type == ENEMY_TYPE::BOSS)
+				return;
 
-		vec2 pos = motion.position - vec2{0.f, abs(motion.scale.y) / 2};
+			// the bars may already be gone, their handles are stale then
+			if (!enemy_health_bars.has(entity) || !entity_handles.is_alive(enemy_health_bars.get(entity).inner))
+				return;
+			Entity inner = entity_handles.get(enemy_health_bars.get(entity).inner);
+			if (!registry.motions.has(inner) || !transform_hierarchy.is_attached(inner))
+				return;
 
-		outer_bar_motion.position = pos;
+			float bar_length = 77.f * (enemy_health.health / 3.f);
+			registry.motions.get(inner).scale.x = bar_length;
+			transform_hierarchy.get(inner).offset.x = -(77.f - bar_length) / 2;
+		});
 
-		float bar_length = 77.f * (enemy_health.health / 3.f);
-		inner_bar_motion.scale.x = bar_length;
-		inner_bar_motion.position = pos + vec2{-(77.f - bar_length) / 2, 0.f};
-	}
+	// one sweep, parents before children
+	transform_hierarchy.update(registry);
 
 	return true;
 }
@@ -721,34 +404,167 @@ void WorldSystem::swap_level(int level_index) {
 	restart_game();
 }
 
+void WorldSystem::reload_levels() {
+	level_system.invalidate();
+	// the next restart has to rebuild the level from the fresh data
+	loaded_level = -1;
+	loaded_level_data = nullptr;
+	checkpoint.registry_state.clear();
+	checkpoint.level = -1;
+}
+
+void WorldSystem::save_checkpoint() {
+	checkpoint.registry_state.capture(registry);
+	checkpoint.level = curr_level;
+	checkpoint.level_time = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - level_start_time).count() - menuSystem.total_pause_duration;
+	checkpoint.player = player;
+	checkpoint.fps_text = fps_text;
+	checkpoint.bullet_text = bullet_text;
+	checkpoint.weapons = weapon_system.available_weapons;
+	checkpoint.equipped_weapon = weapon_system.equipped_weapon;
+	checkpoint.health_icons = HUD_system.health_icons;
+	checkpoint.attachments = transform_hierarchy;
+	checkpoint.handles = entity_handles;
+	checkpoint.health_bars = enemy_health_bars;
+}
+
+// lore and weapons stay collected once picked up, even when going back to a checkpoint
+static bool isCollected(COLLECTABLE_TYPE type)
+{
+	switch (type)
+	{
+	case COLLECTABLE_TYPE::LORE1:
+		return loader.is_lore_found(0);
+	case COLLECTABLE_TYPE::LORE2:
+		return loader.is_lore_found(1);
+	case COLLECTABLE_TYPE::LORE3:
+		return loader.is_lore_found(2);
+	case COLLECTABLE_TYPE::GRENADE_LAUNCHER:
+		return loader.is_grenade_found();
+	default:
+		return false;
+	}
+}
+
+void WorldSystem::respawn() {
+	if (checkpoint.level != curr_level || !checkpoint.registry_state.is_valid())
+	{
+		restart_game();
+		return;
+	}
+
+	auto respawn_start = std::chrono::high_resolution_clock::now();
+	PlayerInputSystem::clear_inputs();
+	disable_input = false;
+
+	checkpoint.registry_state.restore(registry);
+	registry.collisions.clear();
+	// particles are not part of the registry, a respawn starts without any
+	particle_pool.clear();
+	gpu_particles.clear();
+	player = checkpoint.player;
+	fps_text = checkpoint.fps_text;
+	bullet_text = checkpoint.bullet_text;
+	weapon_system.available_weapons = checkpoint.weapons;
+	weapon_system.set_equipped_weapon(checkpoint.equipped_weapon);
+	HUD_system.health_icons = checkpoint.health_icons;
+	transform_hierarchy = checkpoint.attachments;
+	entity_handles = checkpoint.handles;
+	enemy_health_bars = checkpoint.health_bars;
+
+	remove_entities_if(
+		registry.collectables, [](Entity, const Collectable &collectable) { return isCollected(collectable.type); },
+		[](Entity entity) { registry.remove_all_components_of(entity); });
+
+	// the level timer continues from the checkpoint
+	auto now = std::chrono::high_resolution_clock::now();
+	level_start_time = now - std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+		std::chrono::duration<float>(checkpoint.level_time));
+	menuSystem.is_timer_paused = false;
+	menuSystem.total_pause_duration = 0.0f;
+
+	float respawn_ms = std::chrono::duration<float, std::milli>(now - respawn_start).count();
+	LOG_INFO(LOG_CATEGORY::WORLD, "Respawned at checkpoint in %.2f ms", respawn_ms);
+}
+
 // Reset the world state to its initial state, useful for debugging
 void WorldSystem::restart_game() {
 
-	// Debugging for memory/component leaks
-	registry.list_all_components();
-	printf("Restarting\n");
+	auto restart_start = std::chrono::high_resolution_clock::now();
+	LOG_INFO(LOG_CATEGORY::WORLD, "Restarting");
 	PlayerInputSystem::clear_inputs();
 	disable_input = false;
 	isRestarting = true;
 
+	// Restarting the level that is already loaded keeps its walls, background and trigger
+	// boxes, only the entities that move or change during play are rebuilt
+	bool same_level = loaded_level == curr_level && loaded_level_data != nullptr;
+	if (same_level)
+		clear_dynamic_entities();
+	else if (!load_static_level())
+	{
+		// nothing to spawn into, the world stays empty until a reload or level change works
+		isRestarting = false;
+		return;
+	}
+	particle_pool.clear();
+	gpu_particles.clear();
+	// the HUD and enemies are rebuilt below and attach themselves again, every handle into the
+	// old entities goes stale
+	transform_hierarchy.clear();
+	entity_handles.clear();
+	enemy_health_bars.clear();
+
+	spawn_dynamic_entities(*loaded_level_data);
+
+	glfwPollEvents();
+
+	// start timer
+	level_start_time = std::chrono::high_resolution_clock::now();
+	menuSystem.is_timer_paused = false;
+	menuSystem.total_pause_duration = 0.0f;
+
+	float restart_ms = std::chrono::duration<float, std::milli>(level_start_time - restart_start).count();
+	LOG_INFO(LOG_CATEGORY::WORLD, "%s restart took %.2f ms", same_level ? "Fast" : "Full", restart_ms);
+
+	// respawning after a death comes back here
+	save_checkpoint();
+	checkpoint_requested = false;
+
+	isRestarting = false;
+}
+
+// Remove everything and build the current level from scratch
+bool WorldSystem::load_static_level() {
+
+	// Debugging for memory/component leaks
+	registry.list_all_components();
+
 	// Remove all entities that we created
 	// All that have a motion, we could also iterate over all fish, eels, ... but that would be more cumbersome
 	while (registry.motions.entities.size() > 0)
 	    registry.remove_all_components_of(registry.motions.entities.back());
 
-	registry.tbox.clear();
-	registry.level_out.clear();
-	registry.alpha_box.clear();
+	// trigger boxes have no motion, kill boxes also carry a Deadly
+	while (registry.tbox.entities.size() > 0)
+		registry.remove_all_components_of(registry.tbox.entities.back());
 
 	// Debugging for memory/component leaks
 	registry.list_all_components();
 
-	const ldtk::Level *level = loadLDtkFile(level_names[curr_level]);
+	loaded_level_data = level_system.load_level(level_names[curr_level]);
+	if (!loaded_level_data)
+	{
+		LOG_ERROR(LOG_CATEGORY::WORLD, "Could not load level %s", level_names[curr_level].c_str());
+		loaded_level = -1;
+		return false;
+	}
+	loaded_level = curr_level;
+	const LevelData *level = loaded_level_data;
 	//float 
-	level_width = static_cast<float>(level->size.x);
+	level_width = level->width;
 	//float 
-	level_height = static_cast<float>(level->size.y);
-	vec2 playerPosition = getPlayerPosition(level);
+	level_height = level->height;
 
 	TEXTURE_ASSET_ID level_bg = static_cast<TEXTURE_ASSET_ID>(curr_level);
 	// Create background with calculated scaling factor
@@ -756,6 +572,41 @@ void WorldSystem::restart_game() {
 		{level_width / 2 - 32, level_height/2 - 32}, 
 		{level_width, level_height}, level_bg);
 
+	create_world(*level);
+
+	//create level out
+	for (const LevelExitSpawn &levelExit : level->exits) 
+	{
+		createLevelExit(levelExit.to_level, levelExit.top_left, levelExit.bottom_right);
+	}
+
+	//create alpha boxes
+	for (const AlphaBoxSpawn &alphaBox : level->alpha_boxes)
+	{
+		createAlphaBox(alphaBox.alpha, alphaBox.top_left, alphaBox.bottom_right);
+	}
+
+	// create kill boxes
+	for (const KillBoxSpawn &killBox : level->kill_boxes)
+	{
+		createKillBox(killBox.damage, killBox.top_left, killBox.bottom_right);
+	}
+	return true;
+}
+
+// Remove everything that moves, keeping walls, background and trigger boxes
+void WorldSystem::clear_dynamic_entities() {
+	remove_entities_if(
+		registry.motions,
+		[](Entity entity, const Motion &) { return !registry.obstacles.has(entity) && !registry.backgrounds.has(entity); },
+		[](Entity entity) { registry.remove_all_components_of(entity); });
+}
+
+// Player, UI, weapons, enemies and collectables from the level's spawn lists
+void WorldSystem::spawn_dynamic_entities(const LevelData &level_data) {
+	const LevelData *level = &level_data;
+	vec2 playerPosition = level->player_spawn;
+
 	// create a new Player
 	player = createPlayer(renderer, playerPosition, selected_skin);
 	registry.players.get(player).is_dead = false;
@@ -765,12 +616,9 @@ void WorldSystem::restart_game() {
 
 	// crate a new Crosshair
 	if(registry.crosshairs.size() == 0) crosshair = createCrosshair();
-	std::cout << "crosshair" << crosshair <<std::endl;
+	LOG_DEBUG(LOG_CATEGORY::WORLD, "crosshair %u", (unsigned int)crosshair);
 	weapon_system.set_crosshair(crosshair);
 
-	
-	create_world(&level->getLayer("Wall"));
-
 	//create weapon
 	weapon_system.available_weapons.clear(); 
 	//weapon_system.available_weapons.push_back(createWeapon(renderer, {-1, -1}, 0.0, 0.0, 0.0, 0, 0.0, NO_WEAPON));
@@ -788,29 +636,27 @@ void WorldSystem::restart_game() {
 	HUD_system.initializeHUD(player_health);
 
 	// create enemies - location from LDtk
-	auto enemyPositions = getEnemySpawnData(level);
-
 	// Spawn each enemy at its respective position
-	for (const auto &patrolBoxId : getEnemySpawnData(level))
+	for (const PatrolBoxSpawn &patrolBox : level->patrol_boxes)
 	{
-		auto patrolBox = std::get<0>(patrolBoxId.second);
-		for (auto& enemyData : std::get<1>(patrolBoxId.second))
+		for (uint32_t i = patrolBox.first_enemy; i < patrolBox.first_enemy + patrolBox.enemy_count; i++)
 		{
-			vec2 pos = std::get<1>(enemyData);
-			ENEMY_TYPE enemy_type = std::get<0>(enemyData);
+			const EnemySpawn &enemyData = level->enemies[i];
+			vec2 pos = enemyData.position;
+			ENEMY_TYPE enemy_type = (ENEMY_TYPE)enemyData.type;
 			switch (enemy_type)
 			{
 			case ENEMY_TYPE::FLYER:
-				createEnemyFlyer(pos, std::get<0>(patrolBox), std::get<1>(patrolBox));
+				createEnemyFlyer(pos, patrolBox.top_left, patrolBox.bottom_right);
 				break;
 			case ENEMY_TYPE::BOID:
-				createEnemyBoid(pos, std::get<0>(patrolBox), std::get<1>(patrolBox));
+				createEnemyBoid(pos, patrolBox.top_left, patrolBox.bottom_right);
 				break;
 			case ENEMY_TYPE::CHARGER:
-				createEnemyCharger(pos, std::get<0>(patrolBox), std::get<1>(patrolBox));
+				createEnemyCharger(pos, patrolBox.top_left, patrolBox.bottom_right);
 				break;
 			case ENEMY_TYPE::BOSS:
-				createEnemyBoss(pos, std::get<0>(patrolBox), std::get<1>(patrolBox));
+				createEnemyBoss(pos, patrolBox.top_left, patrolBox.bottom_right);
 				HUD_system.initializeBossHealthBar();
 				break;
 			default:
@@ -820,10 +666,10 @@ void WorldSystem::restart_game() {
 	}
 
 	// Spawn collectables at respective position
-	for (const auto &collectableData : getCollectablePos(level))
+	for (const CollectableSpawn &collectableData : level->collectables)
 	{
-		vec2 pos = std::get<1>(collectableData);
-		COLLECTABLE_TYPE collectable_type = std::get<0>(collectableData);
+		vec2 pos = collectableData.position;
+		COLLECTABLE_TYPE collectable_type = (COLLECTABLE_TYPE)collectableData.type;
 		switch (collectable_type)
 		{
 		case COLLECTABLE_TYPE::LORE1:
@@ -854,41 +700,6 @@ void WorldSystem::restart_game() {
 			break;
 		}
 	}
-
-	//create level out
-	std::vector<std::tuple<int, std::tuple<vec2, vec2>>> levelExits = getLevelExits(level);
-
-	for (const auto &levelExit : levelExits) 
-	{
-		createLevelExit(std::get<0>(levelExit), std::get<0>(std::get<1>(levelExit)), std::get<1>(std::get<1>(levelExit)));
-	}
-
-	//create alpha boxes
-	std::vector<std::tuple<float, std::tuple<vec2, vec2>>> alphaBoxes = getAlphaBox(level);
-
-	for (const auto &alphaBox : alphaBoxes)
-	{
-		createAlphaBox(std::get<0>(alphaBox), std::get<0>(std::get<1>(alphaBox)),
-						std::get<1>(std::get<1>(alphaBox)));
-	}
-
-	// create kill boxes
-	std::vector<std::tuple<int, std::tuple<vec2, vec2>>> killBoxes = getKillBox(level);
-
-	for (const auto &killBox : killBoxes)
-	{
-		createKillBox(std::get<0>(killBox), std::get<0>(std::get<1>(killBox)),
-					   std::get<1>(std::get<1>(killBox)));
-	}
-
-	glfwPollEvents();
-
-	// start timer
-	level_start_time = std::chrono::high_resolution_clock::now();
-	menuSystem.is_timer_paused = false;
-	menuSystem.total_pause_duration = 0.0f;
-
-	isRestarting = false;
 }
 
 
@@ -955,6 +766,10 @@ void WorldSystem::handle_collisions()
 		Entity entity = collisionsRegistry.entities[i];
 		Entity entity_other = collisionsRegistry.components[i].other;
 
+		// already destroyed by an earlier collision this step
+		if (destruction_queue.is_pending(entity) || destruction_queue.is_pending(entity_other))
+			continue;
+
 		// Skip collisions with background
 		if ((registry.renderRequests.has(entity) && registry.backgrounds.has(entity)) ||
 			(registry.renderRequests.has(entity_other) && registry.backgrounds.has(entity_other)))
@@ -987,7 +802,7 @@ void WorldSystem::handle_collisions()
 					}
 					// Player interacts with the end game trigger
 					menuSystem.current_state = GAME_STATE::THE_END;
-					std::cout << "The player has reached the end!" << std::endl;
+					LOG_INFO(LOG_CATEGORY::WORLD, "The player has reached the end!");
 
 					registry.texts.remove(bullet_text);
 				}
@@ -1064,7 +879,7 @@ void WorldSystem::handle_collisions()
 
 				if(registry.enemyBullets.has(entity_other))
 				{
-					registry.remove_all_components_of(entity_other);
+					destruction_queue.push(entity_other);
 				}
 			}
 			if (registry.collectables.has(entity_other))
@@ -1076,23 +891,24 @@ void WorldSystem::handle_collisions()
 				{
 				case COLLECTABLE_TYPE::LORE1:
 					loader.set_lore_found(0);
-					registry.remove_all_components_of(entity_other);
+					destruction_queue.push(entity_other);
 					break;
 				case COLLECTABLE_TYPE::LORE2:
 					loader.set_lore_found(1);
-					registry.remove_all_components_of(entity_other);
+					destruction_queue.push(entity_other);
 					break;
 				case COLLECTABLE_TYPE::LORE3:
 					loader.set_lore_found(2);
-					registry.remove_all_components_of(entity_other);
+					destruction_queue.push(entity_other);
 					break;
 				case COLLECTABLE_TYPE::GRENADE_LAUNCHER:
 					loader.set_grenade_found();
-					registry.remove_all_components_of(entity_other);
+					destruction_queue.push(entity_other);
 					break;
 				default:
 					break;
 				}
+				checkpoint_requested = true;
 			}
 
 		}
@@ -1136,13 +952,12 @@ void WorldSystem::handle_collisions()
 							}
 							else if (enemy.enemy_type != ENEMY_TYPE::BOSS && enemy.enemy_type != ENEMY_TYPE::BULLET)
 							{
-								registry.remove_all_components_of(enemy.health_bar_inner);
-								registry.remove_all_components_of(enemy.health_bar_outer);
+								destroyEnemyHealthBar(entity_other);
 							}
 						}
 					}
 				}
-				registry.remove_all_components_of(entity);
+				destruction_queue.push(entity);
 			}
 			continue;
 		}
@@ -1186,11 +1001,10 @@ void WorldSystem::handle_collisions()
 						}
 						else if (enemy.enemy_type != ENEMY_TYPE::BOSS && enemy.enemy_type != ENEMY_TYPE::BULLET)
 						{
-							registry.remove_all_components_of(enemy.health_bar_inner);
-							registry.remove_all_components_of(enemy.health_bar_outer);
+							destroyEnemyHealthBar(entity_other);
 						}
 					}
-					registry.remove_all_components_of(entity);
+					destruction_queue.push(entity);
 				}
 			}
 			else
@@ -1202,19 +1016,14 @@ void WorldSystem::handle_collisions()
 					continue;
 				}
 
-				if (debugging.in_debug_mode && registry.debugComponents.has(entity_other))
-				{
-					continue;
-				}
-
 				if (registry.bullets.has(entity_other))
 				{
-					registry.remove_all_components_of(entity_other);
+					destruction_queue.push(entity_other);
 				}
 
 				if (!registry.players.has(entity_other))
 				{
-					registry.remove_all_components_of(entity);
+					destruction_queue.push(entity);
 				}
 			}
 		}
@@ -1278,6 +1087,9 @@ void WorldSystem::handle_collisions()
 		}
 	}
 
+	// sync point, everything destroyed by a collision goes away together
+	destruction_queue.flush(registry);
+
 	// Remove all collisions from this simulation step
 	registry.collisions.clear();
 }
@@ -1318,6 +1130,12 @@ void WorldSystem::on_key(int key, int, int action, int mod) {
 	{
 		debugging.in_invincibility_mode = !debugging.in_invincibility_mode;
 	}
+	// pick up level edits without restarting the game
+	if (key == GLFW_KEY_F5 && action == GLFW_PRESS)
+	{
+		reload_levels();
+		restart_game();
+	}
 }
 
 
@@ -1424,7 +1242,7 @@ void WorldSystem::addDeathTimer(Entity entity)
 	if (!registry.deathTimers.has(entity))
 	{
 		registry.deathTimers.emplace(entity, DeathTimer{death_timer_duration});
-		std::cout << "Death Timer Added: " << death_timer_duration << " seconds" << std::endl;
+		LOG_DEBUG(LOG_CATEGORY::WORLD, "Death Timer Added: %.2f seconds", death_timer_duration);
 	}
 }
 
@@ -16,6 +16,10 @@
 
 #include "renderer/render_system.hpp"
 #include "player/player_input_system.hpp"
+#include "world/level_system.hpp"
+#include "engine/registry_snapshot.hpp"
+#include "engine/transform_hierarchy.hpp"
+#include "world/world_init.hpp"
 
 #include <LDtkLoader/Entity.hpp>
 #include <LDtkLoader/Layer.hpp>
@@ -57,6 +61,20 @@ public:
 	// swap to new level
 	void swap_level(int level_index);
 
+	// drop the cached LDtk project, the next restart parses GunCat.ldtk again. Bound to F5,
+	// which also restarts the level. A plain restart of the same level reuses the loaded
+	// level data and does not look at the file, so LDtk edits only show up after F5 or a
+	// level change. Any LevelData or ldtk pointer held before is stale after this and has
+	// to be fetched again through level_system.
+	void reload_levels();
+
+	// remember the current state, dying or falling out of the level goes back to it. Called
+	// when a level starts and again after every pickup.
+	void save_checkpoint();
+
+	// back to the last checkpoint of this level, restarts the level if there is none
+	void respawn();
+
 	//default skin
 	Skin selected_skin;
 
@@ -75,7 +93,13 @@ private:
 
 	// place entites in world at game start
 	// void create_world();
-	void create_world(const ldtk::Layer *layer);
+	void create_world(const LevelData &level);
+
+	// restart_game helpers. load_static_level is false when the level could not be loaded,
+	// loaded_level stays -1 then.
+	bool load_static_level();
+	void clear_dynamic_entities();
+	void spawn_dynamic_entities(const LevelData &level_data);
 
 	// swap to new level
 	// void swap_level(int level_index);
@@ -118,7 +142,30 @@ private:
 	float level_height;
 	float level_width;
 
-	std::string project_path = ldtk_path("GunCat.ldtk");
-
 	std::vector<std::string> level_names = {"Level_0", "Level_1", "Level_2", "Level_3"};
+
+	// level whose walls, background and trigger boxes are currently in the registry
+	int loaded_level = -1;
+	const LevelData *loaded_level_data = nullptr;
+
+	// registry state at the last checkpoint and the handles that go with it
+	struct Checkpoint
+	{
+		RegistrySnapshot registry_state;
+		int level = -1;
+		float level_time = 0.f;
+		Entity player;
+		Entity fps_text;
+		Entity bullet_text;
+		std::vector<Entity> weapons;
+		Entity equipped_weapon;
+		std::vector<Entity> health_icons;
+		// not part of the registry, restored with it
+		TransformHierarchy attachments;
+		EntityHandles handles;
+		SparseComponentContainer<EnemyHealthBarHandles> health_bars;
+	};
+	Checkpoint checkpoint;
+	// set by a pickup, saved at the end of the step once the pickup is gone
+	bool checkpoint_requested = false;
 };